@@ -38,3 +38,234 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+// Where the time goes when the editor opens, component by component.
+// The whole editor should open in well under 10ms.
+template <typename ComponentType, typename... Args>
+static void measureConstruction (Catch::Benchmark::Chronometer& meter, Args&... args)
+{
+    std::vector<Catch::Benchmark::storage_for<ComponentType>> storage (size_t (meter.runs()));
+    meter.measure ([&] (int i) { storage[(size_t) i].construct (args...); });
+}
+
+TEST_CASE ("Editor open breakdown")
+{
+    BENCHMARK_ADVANCED ("CustomLookNFeel")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        measureConstruction<CustomLookNFeel> (meter);
+    };
+
+    BENCHMARK_ADVANCED ("DelayComponent")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        PluginProcessor plugin;
+        juce::Component owner;
+        RepaintCoordinator coordinator { owner };
+        measureConstruction<DelayComponent> (meter, plugin.getApvts(), coordinator);
+    };
+
+    BENCHMARK_ADVANCED ("ReverbComponent")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        PluginProcessor plugin;
+        juce::Component owner;
+        RepaintCoordinator coordinator { owner };
+        measureConstruction<ReverbComponent> (meter, plugin.getApvts(), coordinator);
+    };
+
+    BENCHMARK_ADVANCED ("PresetManagerComponent")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        PluginProcessor plugin;
+        measureConstruction<PresetManagerComponent> (meter, plugin.getApvts(), plugin.getPresetMorph(), plugin.getAuditionPlayer());
+    };
+
+    BENCHMARK_ADVANCED ("VisualizerComponent (created after opening)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        PluginProcessor plugin;
+        measureConstruction<VisualizerComponent> (meter, plugin.getVisualizerFifo());
+    };
+
+    BENCHMARK_ADVANCED ("Editor constructor")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        PluginProcessor plugin;
+        std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors (size_t (meter.runs()));
+
+        meter.measure ([&] (int i) { editors[(size_t) i].reset (plugin.createEditor()); });
+
+        for (auto& editor : editors)
+        {
+            plugin.editorBeingDeleted (editor.get());
+            editor.reset();
+        }
+    };
+}
+
+// Same audio, in fixed or in random block sizes (as some hosts do).
+TEST_CASE ("Processing")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxBlockSize = 512;
+    constexpr int numSamples = 48000;
+
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    plugin.setRateAndBufferSizeDetails (sampleRate, maxBlockSize);
+    plugin.prepareToPlay (sampleRate, maxBlockSize);
+
+    juce::AudioBuffer<float> audio (2, numSamples);
+    juce::Random random (42);
+    for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+        for (int sample = 0; sample < numSamples; ++sample)
+            audio.setSample (channel, sample, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+
+    // Drawn beforehand, so that only the processing is measured.
+    std::vector<int> randomBlockSizes;
+    for (int total = 0; total < numSamples;)
+    {
+        randomBlockSizes.push_back (juce::jmin (numSamples - total, 1 + random.nextInt (maxBlockSize)));
+        total += randomBlockSizes.back();
+    }
+
+    juce::MidiBuffer midi;
+    auto processInBlocks = [&] (const std::function<int (size_t)>& blockSize)
+    {
+        size_t blockIndex = 0;
+        for (int start = 0; start < numSamples; ++blockIndex)
+        {
+            const auto length = juce::jmin (numSamples - start, blockSize (blockIndex));
+            juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), audio.getNumChannels(), start, length);
+            plugin.processBlock (block, midi);
+            start += length;
+        }
+        return audio.getSample (0, 0);
+    };
+
+    BENCHMARK ("1s of audio, fixed blocks of 512")
+    {
+        return processInBlocks ([] (size_t) { return maxBlockSize; });
+    };
+
+    BENCHMARK ("1s of audio, random blocks of 1 to 512")
+    {
+        return processInBlocks ([&] (size_t index) { return randomBlockSizes[index]; });
+    };
+
+    // Tape wow and flutter, the most expensive LFO shape.
+    auto& apvts = plugin.getApvts();
+    apvts.getParameter ("Delay Mod Depth")->setValueNotifyingHost (apvts.getParameter ("Delay Mod Depth")->convertTo0to1 (5.0f));
+    apvts.getParameter ("Delay Mod Shape")->setValueNotifyingHost (1.0f);
+
+    BENCHMARK ("1s of audio, fixed blocks of 512, modulated delay")
+    {
+        return processInBlocks ([] (size_t) { return maxBlockSize; });
+    };
+
+    // 32 pitched grains at all times.
+    apvts.getParameter ("Delay Mode")->setValueNotifyingHost (1.0f);
+    apvts.getParameter ("Delay Grain Density")->setValueNotifyingHost (1.0f);
+    apvts.getParameter ("Delay Grain Pitch Jitter")->setValueNotifyingHost (apvts.getParameter ("Delay Grain Pitch Jitter")->convertTo0to1 (7.0f));
+
+    BENCHMARK ("1s of audio, fixed blocks of 512, 32 grains")
+    {
+        return processInBlocks ([] (size_t) { return maxBlockSize; });
+    };
+
+    apvts.getParameter ("Delay Shimmer")->setValueNotifyingHost (0.5f);
+
+    BENCHMARK ("1s of audio, fixed blocks of 512, 32 grains and shimmer")
+    {
+        return processInBlocks ([] (size_t) { return maxBlockSize; });
+    };
+}
+
+// A bounce: long blocks, offline, with the delay's channels on one thread or spread out.
+TEST_CASE ("Offline rendering")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 2 * PluginProcessor::minParallelBlockSize;
+    constexpr int numSamples = 10 * blockSize;
+
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    juce::AudioBuffer<float> audio (2, numSamples);
+    juce::Random random (42);
+    for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+        for (int sample = 0; sample < numSamples; ++sample)
+            audio.setSample (channel, sample, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+
+    for (const auto parallel : { false, true })
+    {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getApvts();
+        apvts.getParameter ("Delay Mod Depth")->setValueNotifyingHost (apvts.getParameter ("Delay Mod Depth")->convertTo0to1 (5.0f));
+        apvts.getParameter ("Delay Shimmer")->setValueNotifyingHost (0.5f);
+
+        plugin.setNonRealtime (true);
+        plugin.setParallelRendering (parallel);
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+
+        juce::MidiBuffer midi;
+        BENCHMARK (parallel ? "10 blocks of 16384, modulated delay and shimmer, parallel" : "10 blocks of 16384, modulated delay and shimmer, serial")
+        {
+            for (int start = 0; start < numSamples; start += blockSize)
+            {
+                juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), audio.getNumChannels(), start, blockSize);
+                plugin.processBlock (block, midi);
+            }
+            return audio.getSample (0, 0);
+        };
+    }
+}
+
+// What a host waits for when it changes a setting: the sample rate or the block size,
+// and a full restart after releaseResources().
+TEST_CASE ("Prepare")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+    apvts.getParameter ("Delay Time")->setValueNotifyingHost (apvts.getParameter ("Delay Time")->convertTo0to1 (100.0f));
+    apvts.getParameter ("Plugin Dry Wet")->setValueNotifyingHost (1.0f);
+
+    plugin.setRateAndBufferSizeDetails (48000.0, 512);
+    plugin.prepareToPlay (48000.0, 512);
+
+    BENCHMARK ("prepareToPlay, same settings")
+    {
+        plugin.prepareToPlay (48000.0, 512);
+        return plugin.getLatencySamples();
+    };
+
+    int run = 0;
+    BENCHMARK ("prepareToPlay, block size changed")
+    {
+        plugin.prepareToPlay (48000.0, ++run % 2 == 0 ? 512 : 256);
+        return plugin.getLatencySamples();
+    };
+
+    BENCHMARK ("prepareToPlay, 44.1k and 48k in turn")
+    {
+        plugin.prepareToPlay (++run % 2 == 0 ? 48000.0 : 44100.0, 512);
+        return plugin.getLatencySamples();
+    };
+
+    BENCHMARK ("releaseResources then prepareToPlay")
+    {
+        plugin.releaseResources();
+        plugin.prepareToPlay (48000.0, 512);
+        return plugin.getLatencySamples();
+    };
+
+    plugin.releaseResources();
+}
@@ -0,0 +1,318 @@
+#include "PluginProcessor.h"
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if JUCE_LINUX
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+/*
+ * How the plugin scales with the number of instances, the way a DAW runs
+ * them: every audio callback, the processBlock() of every instance is
+ * dispatched over a pool of worker threads, and the callback is over when
+ * all of them are done.
+ *
+ * The p99 that matters is the one of whole callbacks, the deadline is per
+ * callback. The p99 of single processBlock() calls comes next to it.
+ *
+ * Hidden, it takes a while:   ./Benchmarks "[multi-instance]"
+ */
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    /**
+     * @brief The p-th quantile of values, 0 when empty. Sorts values.
+     */
+    double getPercentile (std::vector<double>& values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort (values.begin(), values.end());
+        return values[static_cast<size_t> (p * static_cast<double> (values.size() - 1))];
+    }
+
+    /**
+     * @brief Resident memory of the process in bytes, 0 where unknown.
+     */
+    juce::int64 getResidentMemory()
+    {
+#if JUCE_LINUX
+        const auto status = juce::File ("/proc/self/status").loadFileAsString();
+        for (const auto& line : juce::StringArray::fromLines (status))
+            if (line.startsWith ("VmRSS:"))
+                return line.fromFirstOccurrenceOf (":", false, false).trim().getLargeIntValue() * 1024; // in kB
+#endif
+        return 0;
+    }
+
+    /**
+     * @brief Last level cache misses of this process and of the threads it
+     *        creates afterwards, through perf_event_open. Not available
+     *        elsewhere than on Linux, nor when perf_event_paranoid forbids it.
+     */
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter()
+        {
+#if JUCE_LINUX
+            perf_event_attr attributes {};
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.size = sizeof (attributes);
+            attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+            attributes.disabled = 1;
+            attributes.inherit = 1; // counts the workers too
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+
+            fd = static_cast<int> (syscall (SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#if JUCE_LINUX
+            if (fd >= 0)
+                close (fd);
+#endif
+        }
+
+        bool isAvailable() const { return fd >= 0; }
+
+        void start()
+        {
+#if JUCE_LINUX
+            if (fd >= 0)
+            {
+                ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        juce::int64 stop()
+        {
+            juce::int64 count = 0;
+#if JUCE_LINUX
+            if (fd >= 0)
+            {
+                ioctl (fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read (fd, &count, sizeof (count)) != sizeof (count))
+                    count = 0;
+            }
+#endif
+            return count;
+        }
+
+    private:
+        int fd = -1;
+    };
+
+    /**
+     * @brief Workers spinning on a callback counter, like a DAW's audio
+     *        worker threads. Each callback, they grab instances off an
+     *        atomic index until every instance has been processed.
+     */
+    class WorkerPool
+    {
+    public:
+        WorkerPool (int numThreads, std::vector<std::unique_ptr<PluginProcessor>>& processors, std::vector<juce::AudioBuffer<float>>& buffers)
+            : instances (processors), audio (buffers), latencies (static_cast<size_t> (numThreads))
+        {
+            for (int i = 0; i < numThreads; ++i)
+                threads.emplace_back ([this, i]() { run (static_cast<size_t> (i)); });
+        }
+
+        ~WorkerPool()
+        {
+            shouldExit.store (true);
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        void reserve (size_t numLatencies)
+        {
+            for (auto& threadLatencies : latencies)
+                threadLatencies.reserve (numLatencies);
+        }
+
+        /**
+         * @brief Runs one audio callback and returns when it's over.
+         */
+        void runCallback()
+        {
+            remaining.store (static_cast<int> (instances.size()));
+            nextInstance.store (0);
+            callback.fetch_add (1, std::memory_order_release);
+
+            while (remaining.load (std::memory_order_acquire) > 0)
+                std::this_thread::yield();
+        }
+
+        std::vector<double> collectLatencies() const
+        {
+            std::vector<double> all;
+            for (const auto& threadLatencies : latencies)
+                all.insert (all.end(), threadLatencies.begin(), threadLatencies.end());
+            return all;
+        }
+
+    private:
+        void run (size_t threadIndex)
+        {
+            juce::MidiBuffer midi;
+            int lastCallback = 0;
+
+            while (!shouldExit.load())
+            {
+                const auto currentCallback = callback.load (std::memory_order_acquire);
+                if (currentCallback == lastCallback)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (;;)
+                {
+                    const auto index = nextInstance.fetch_add (1);
+                    if (index >= static_cast<int> (instances.size()))
+                        break;
+
+                    const auto start = std::chrono::steady_clock::now();
+                    instances[static_cast<size_t> (index)]->processBlock (audio[static_cast<size_t> (index)], midi);
+                    const auto end = std::chrono::steady_clock::now();
+
+                    latencies[threadIndex].push_back (std::chrono::duration<double, std::micro> (end - start).count());
+                    remaining.fetch_sub (1, std::memory_order_acq_rel);
+                }
+
+                lastCallback = currentCallback;
+            }
+        }
+
+        std::vector<std::unique_ptr<PluginProcessor>>& instances;
+        std::vector<juce::AudioBuffer<float>>& audio;
+        std::vector<std::vector<double>> latencies; // one per thread, in microseconds
+
+        std::vector<std::thread> threads;
+        std::atomic<int> callback { 0 }, nextInstance { 0 }, remaining { 0 };
+        std::atomic<bool> shouldExit { false };
+    };
+}
+
+TEST_CASE ("Multi-instance scaling", "[.multi-instance]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const auto numThreads = static_cast<int> (juce::jmax (1u, std::thread::hardware_concurrency()));
+    CacheMissCounter cacheMisses; // before the workers, so that they inherit it
+
+    std::cout << "\nMulti-instance scaling, " << numThreads << " worker threads, "
+              << blockSize << " samples at " << sampleRate << "Hz\n"
+              << std::setw (10) << "instances"
+              << std::setw (16) << "x realtime"
+              << std::setw (14) << "efficiency"
+              << std::setw (20) << "callback p99 (us)"
+              << std::setw (18) << "block p99 (us)"
+              << std::setw (14) << "RSS (MB)"
+              << std::setw (20) << "LLC misses/call" << "\n";
+
+    double singleInstanceThroughput = 0.0;
+
+    for (int numInstances = 1; numInstances <= 512; numInstances *= 2)
+    {
+        std::vector<std::unique_ptr<PluginProcessor>> processors;
+        std::vector<juce::AudioBuffer<float>> buffers;
+        juce::Random random (numInstances);
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto processor = std::make_unique<PluginProcessor>();
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+            processors.push_back (std::move (processor));
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                    buffer.setSample (channel, sample, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+            buffers.push_back (std::move (buffer));
+        }
+
+        // Roughly the same amount of work for every instance count.
+        const auto numCallbacks = juce::jlimit (50, 2000, 16384 / numInstances);
+
+        // Warm up, so that the delay lines and the caches are in use.
+        {
+            WorkerPool warmUp (numThreads, processors, buffers);
+            for (int i = 0; i < 10; ++i)
+                warmUp.runCallback();
+        }
+
+        // The counts of inherited events are only added up when the threads
+        // exit, so the measured pool lives between start() and stop().
+        std::vector<double> latencies, callbackLatencies;
+        callbackLatencies.reserve (static_cast<size_t> (numCallbacks));
+        double elapsed = 0.0;
+        cacheMisses.start();
+        {
+            WorkerPool pool (numThreads, processors, buffers);
+            pool.reserve (static_cast<size_t> (numCallbacks * numInstances));
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < numCallbacks; ++i)
+            {
+                const auto callbackStart = std::chrono::steady_clock::now();
+                pool.runCallback();
+                callbackLatencies.push_back (std::chrono::duration<double, std::micro> (std::chrono::steady_clock::now() - callbackStart).count());
+            }
+
+            elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+            latencies = pool.collectLatencies();
+        }
+        const auto misses = cacheMisses.stop();
+
+        const auto callbackP99 = getPercentile (callbackLatencies, 0.99);
+        const auto blockP99 = getPercentile (latencies, 0.99);
+
+        // Seconds of audio for every instance processed per second.
+        const auto audioSeconds = static_cast<double> (numCallbacks) * blockSize / sampleRate * numInstances;
+        const auto throughput = audioSeconds / elapsed;
+
+        if (numInstances == 1)
+            singleInstanceThroughput = throughput;
+
+        // 1.0 when the plugin scales linearly up to the number of threads.
+        const auto efficiency = throughput / (singleInstanceThroughput * juce::jmin (numInstances, numThreads));
+
+        std::cout << std::setw (10) << numInstances
+                  << std::setw (16) << std::fixed << std::setprecision (1) << throughput
+                  << std::setw (14) << std::setprecision (2) << efficiency
+                  << std::setw (20) << std::setprecision (1) << callbackP99
+                  << std::setw (18) << blockP99
+                  << std::setw (14) << static_cast<double> (getResidentMemory()) / (1024.0 * 1024.0);
+
+        if (cacheMisses.isAvailable())
+            std::cout << std::setw (20) << static_cast<double> (misses) / (static_cast<double> (numCallbacks) * numInstances);
+        else
+            std::cout << std::setw (20) << "n/a";
+
+        std::cout << std::endl;
+
+        CHECK (latencies.size() == static_cast<size_t> (numCallbacks * numInstances));
+    }
+}
@@ -1,13 +1,28 @@
 #include "Delay.hpp"
+#include "../Health/HealthCheck.hpp"
+#include "../Parallel/RenderThreadPool.hpp"
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_core/system/juce_PlatformDefs.h"
 #include <memory>
+#include <utility>
 
 Delay::Delay (juce::AudioProcessorValueTreeState& valueTree) : apvts (valueTree),
                                                                mDelayTimeParameter (dynamic_cast<juce::AudioParameterInt*> (apvts.getParameter ("Delay Time"))),
                                                                mDelayFeedbackParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Feedback"))),
                                                                mDelaySyncToggleParameter (dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("Delay Sync Toggle"))),
-                                                               mDelaySyncParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Delay Sync")))
+                                                               mDelaySyncParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Delay Sync"))),
+                                                               mModRateParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Mod Rate"))),
+                                                               mModDepthParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Mod Depth"))),
+                                                               mModShapeParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Delay Mod Shape"))),
+                                                               mModStereoParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Mod Stereo"))),
+                                                               mModeParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Delay Mode"))),
+                                                               mGrainSizeParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Grain Size"))),
+                                                               mGrainDensityParameter (dynamic_cast<juce::AudioParameterInt*> (apvts.getParameter ("Delay Grain Density"))),
+                                                               mGrainPitchJitterParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Grain Pitch Jitter"))),
+                                                               mGrainPositionJitterParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Grain Position Jitter"))),
+                                                               mShimmerParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Delay Shimmer"))),
+                                                               mShimmerPitchParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Delay Shimmer Pitch"))),
+                                                               mFreezeParameter (dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("Delay Freeze")))
 {
 }
 
@@ -18,48 +33,353 @@ void Delay::setSampleRate (int rate)
 
 void Delay::prepare (int numInputChannels, double sampleRate, int samplesPerBlock)
 {
+    const auto previousSampleRate = mSampleRate;
     mSampleRate = static_cast<int>(sampleRate);
-    const auto bufferSize = 2 * (mSampleRate + samplesPerBlock);
+    // the longest delay, plus the deepest modulation and the interpolation's neighbours,
+    // or the furthest a grain reads: only one of them reads at a time.
+    const auto maxModulationSamples = static_cast<int> (std::ceil (maxModDepthMs * static_cast<float> (mSampleRate) / 1000.0f)) + 4;
+    const auto maxExtraSamples = juce::jmax (maxModulationSamples, GrainEngine::getMaxExtraDelayInSamples (sampleRate));
+    const auto bufferSize = 2 * (mSampleRate + samplesPerBlock) + maxExtraSamples;
 
-    mDelayBuffer.setSize (numInputChannels, bufferSize);
+    // A longer buffer than needed works just as well: nothing to do.
+    if (mSampleRate == previousSampleRate && numInputChannels == mDelayBuffer.getNumChannels() && bufferSize <= mDelayBuffer.getNumSamples())
+        return;
+
+    // The old buffer is the source of the resampling, then it's freed.
+    const auto previous = std::move (mDelayBuffer);
+    mDelayBuffer = juce::AudioBuffer<float> (numInputChannels, bufferSize);
     mDelayBuffer.clear();
+
+    resampleFrom (previous, static_cast<double> (previousSampleRate));
+}
+
+void Delay::resampleFrom (const juce::AudioBuffer<float>& previous, double previousSampleRate)
+{
+    const auto previousLength = previous.getNumSamples();
+    const auto length = mDelayBuffer.getNumSamples();
+    const auto numChannels = juce::jmin (previous.getNumChannels(), mDelayBuffer.getNumChannels());
+
+    // Everything previous holds, as far back as the new buffer goes, ends up before a write position of 0.
+    const auto ratio = previousSampleRate / static_cast<double> (mSampleRate); // previous samples per new sample
+    const auto numSamples = previousLength > 2 ? juce::jmin (length, static_cast<int> (static_cast<double> (previousLength - 2) / ratio)) : 0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = previous.getReadPointer (channel);
+        auto* destination = mDelayBuffer.getWritePointer (channel);
+
+        for (int k = 1; k <= numSamples; ++k)
+        {
+            // k new samples ago is that many previous samples before the previous write
+            // position, the last sample written being 1 sample ago.
+            const auto age = juce::jmax (1.0, static_cast<double> (k) * ratio);
+            const auto wholeAge = static_cast<int> (age);
+            const auto t = static_cast<float> (age - wholeAge);
+
+            const auto newer = source[(mWritePosition - wholeAge + 2 * previousLength) % previousLength];
+            const auto older = source[(mWritePosition - wholeAge - 1 + 2 * previousLength) % previousLength];
+            destination[length - k] = newer + t * (older - newer);
+        }
+    }
+
+    mWritePosition = 0;
+    mLastWriteStart = 0;
+    mLastWriteLength = 0;
 }
 
 void Delay::prepare(const juce::dsp::ProcessSpec& specs)
 {
-    // inner call to prepare() with specs' params.
+    // inner call to prepare() with specs' params. The delay buffer's contents are carried over, see reset().
     prepare(specs.numChannels, specs.sampleRate, specs.maximumBlockSize);
 
-    tempBuffer.setSize(specs.numChannels, specs.maximumBlockSize);
+    tempBuffer.setSize(specs.numChannels, specs.maximumBlockSize, false, false, true);
+    mModulationBuffer.setSize(specs.numChannels, specs.maximumBlockSize, false, false, true);
+    mLfo.prepare(specs.sampleRate, specs.maximumBlockSize);
+    mGrains.prepare(specs.sampleRate, specs.maximumBlockSize);
+    mShimmer.prepare(static_cast<int> (specs.numChannels));
+    mShimmerBuffer.setSize(specs.numChannels, specs.maximumBlockSize, false, false, true);
+    mShimmerWasActive = false;
+    mDelayFadeBuffer.setSize(specs.numChannels, specs.maximumBlockSize, false, false, true);
+    mDelayFadeLength = juce::jmax(1, static_cast<int> (delayFadeSeconds * specs.sampleRate));
+    // At another sample rate, the old delay in samples means nothing: the first block snaps to its own.
+    mReadDelay = 0;
+    mDelayFade = 0;
+    // The loop has to be taken again from the delay buffer.
+    mFrozen = false;
+    mUnfreezeFade = 0;
+
+    // Starts from the current values, the first block doesn't ramp from the defaults.
+    setParameters(dumpParametersFromAPVTS());
+    mPreviousMode = mParameters.mode;
+    mPreviousFeedback = mParameters.feedback;
+    mPreviousModDepth = mParameters.modDepthMs * static_cast<float> (mSampleRate) / 1000.0f;
+}
+
+void Delay::reset()
+{
+    mDelayBuffer.clear();
+    mWritePosition = 0;
+    mLastWriteStart = 0;
+    mLastWriteLength = 0;
+
+    mLfo.reset();
+    mGrains.reset();
+    mShimmer.reset();
+    mFrozen = false;
+    mUnfreezeFade = 0;
+    mReadDelay = 0;
+    mDelayFade = 0;
 }
 
 
 void Delay::process (juce::dsp::ProcessContextReplacing<float>& context)
 {
-    auto&& block = context.getInputBlock();
-    auto numChannels = block.getNumChannels();
-    auto bufferLength = tempBuffer.getNumSamples();
+    auto&& block = context.getOutputBlock();
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), mDelayBuffer.getNumChannels());
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto delayBufferLength = mDelayBuffer.getNumSamples();
 
+    // Hosts may send anything up to the size given to prepare().
+    jassert (numSamples <= tempBuffer.getNumSamples());
 
-    for (int channel = 0; channel < numChannels; ++channel)
+    // Freezing loops over what the last delayInSamples samples wrote, with its start
+    // and end where the read and write heads are: the output goes on seamlessly.
+    const auto freeze = mFreezeParameter->get();
+    if (freeze != mFrozen)
+    {
+        mFrozen = freeze;
+
+        if (mFrozen)
+        {
+            mLoopLength = juce::jmax (2, mReadDelay > 0 ? mReadDelay : getDelayInSamples());
+            mDelayFade = 0;
+            mLoopStart = (mWritePosition + delayBufferLength - mLoopLength) % delayBufferLength;
+            mLoopPosition = 0;
+            mLoopCrossfade = juce::jlimit (1, mLoopLength / 2, static_cast<int> (0.01 * mSampleRate));
+            mUnfreezeFade = 0;
+        }
+        else
+        {
+            mUnfreezeFade = mLoopCrossfade;
+        }
+    }
+
+    mLastWriteStart = mWritePosition;
+    mLastWriteLength = mFrozen ? 0 : numSamples;
+
+    // Frozen: a plain looped read, nothing is written, no feedback, no modulation.
+    if (mFrozen)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            readFrozenLoop (channel, block.getChannelPointer (static_cast<size_t> (channel)), numSamples, mLoopPosition);
+
+        mLoopPosition = (mLoopPosition + numSamples) % mLoopLength;
+        mPreviousFeedback = mParameters.feedback;
+        return;
+    }
+
+    // Grains start over from scratch when the mode changes.
+    const auto mode = mParameters.mode;
+    const auto grains = mode != normalMode;
+
+    if (mode != mPreviousMode)
+    {
+        mGrains.reset();
+        mPreviousMode = mode;
+    }
+
+    if (grains)
     {
-        auto* bufferData = block.getChannelPointer (channel);
-        tempBuffer.copyFrom(channel, 0, bufferData, block.getNumSamples());
-        auto dryBuffer = tempBuffer.getWritePointer (channel);
+        GrainEngine::Parameters grainParameters;
+        grainParameters.grainSizeMs      = mParameters.grainSizeMs;
+        grainParameters.density          = mParameters.grainDensity;
+        grainParameters.pitchJitter      = mParameters.grainPitchJitter;
+        grainParameters.positionJitterMs = mParameters.grainPositionJitterMs;
 
-        // read the values from buffer and store them in delayBuffer.
-        fillDelayBuffer (channel, bufferLength, bufferData);
-        // read the values from the delayBuffer and write them to the audio buffer.
-        getFromDelayBuffer (tempBuffer, channel, bufferLength);
-        // apply feedback
-        feedbackDelay (channel, bufferLength, dryBuffer);
+        mGrains.setParameters (mode == reverseMode ? GrainEngine::Mode::reverse : GrainEngine::Mode::granular, grainParameters, getDelayInSamples());
     }
-    /* We read bufferLength values so we need to increment the write position
-     * so that, next time, we read once again bufferLength values but don't 
-     * overwrite the previously saved values.
+
+    // Modulation depth, in samples. Zero means a plain, fixed read head.
+    const auto modDepth = mParameters.modDepthMs * static_cast<float> (mSampleRate) / 1000.0f;
+    const auto modulated = !grains && (modDepth > 0.0f || mPreviousModDepth > 0.0f);
+
+    if (modulated)
+        mLfo.setParameters (mParameters.modRate, static_cast<LfoBank::Shape> (mParameters.modShape), mParameters.modStereo / 360.0f);
+
+    // How much of the feedback is pitch shifted. The shifter starts
+    // from silence rather than from what it had when last used.
+    const auto shimmer = mParameters.shimmer;
+    const auto shimmerActive = shimmer > 0.0f;
+
+    if (shimmerActive)
+    {
+        if (!mShimmerWasActive)
+            mShimmer.reset();
+
+        mShimmer.setPitchRatio (mShimmerRatiosLUT[mParameters.shimmerPitch]);
+    }
+
+    mShimmerWasActive = shimmerActive;
+
+    // The read head crossfades to a new delay time rather than jumping there. The grains have none.
+    const auto targetDelay = getDelayInSamples();
+    if (grains || mReadDelay == 0)
+    {
+        mReadDelay = targetDelay;
+        mDelayFade = 0;
+    }
+    else if (mDelayFade == 0 && targetDelay != mReadDelay)
+    {
+        mFadeFromDelay = mReadDelay;
+        mReadDelay = targetDelay;
+        mDelayFade = mDelayFadeLength;
+    }
+
+    /* A chunk is never longer than the delay, so that every sample we read
+     * was written by a previous chunk, feedback included. The output is then
+     * the same whatever the size of the blocks. The interpolation of the
+     * modulated read and of the grains looks one sample further, hence one
+     * sample less. While crossfading, both read heads count.
      */
-    mWritePosition += bufferLength;
-    mWritePosition %= mDelayBuffer.getNumSamples(); // wrap around
+    const auto shortestDelay = mDelayFade > 0 ? juce::jmin (mReadDelay, mFadeFromDelay) : mReadDelay;
+    const auto chunkSize = juce::jlimit (1, tempBuffer.getNumSamples(), shortestDelay - (modulated || grains ? 1 : 0));
+
+    // The feedback and depth ramps span the whole block, not each chunk.
+    const auto startFeedback = mPreviousFeedback;
+    const auto feedbackIncrement = (mParameters.feedback - mPreviousFeedback) / static_cast<float> (juce::jmax (1, numSamples));
+    const auto startDepth = mPreviousModDepth;
+    const auto depthIncrement = (modDepth - mPreviousModDepth) / static_cast<float> (juce::jmax (1, numSamples));
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto bufferLength = juce::jmin (chunkSize, numSamples - start);
+        const auto startGain = startFeedback + feedbackIncrement * static_cast<float> (start);
+        const auto endGain = startFeedback + feedbackIncrement * static_cast<float> (start + bufferLength);
+
+        if (modulated)
+            mLfo.process (mModulationBuffer.getArrayOfWritePointers(), numChannels, bufferLength);
+
+        const auto delayFadeLength = juce::jmin (bufferLength, mDelayFade);
+
+        // the grains only read previous chunks, they can go before this one is written.
+        if (grains)
+            mGrains.process (mDelayBuffer, mWritePosition, tempBuffer, numChannels, bufferLength);
+
+        // From here on the channels are independent, long chunks are worth sharing out between threads.
+        auto processChannel = [&] (int channel)
+        {
+            auto* bufferData = block.getChannelPointer (static_cast<size_t> (channel)) + start;
+
+            auto readDelayed = [&] (juce::AudioBuffer<float>& destination, int delayInSamples)
+            {
+                if (modulated)
+                    getFromDelayBufferModulated (destination, channel, bufferLength, delayInSamples, mModulationBuffer.getReadPointer (channel),
+                                                 startDepth + depthIncrement * static_cast<float> (start),
+                                                 startDepth + depthIncrement * static_cast<float> (start + bufferLength));
+                else
+                    getFromDelayBuffer (destination, channel, bufferLength, delayInSamples);
+            };
+
+            // read the values from buffer and store them in delayBuffer.
+            fillDelayBuffer (channel, bufferLength, bufferData);
+            // read the values from the delayBuffer and write them to tempBuffer (the grains already did).
+            if (!grains)
+            {
+                readDelayed (tempBuffer, mReadDelay);
+
+                // still fading from the previous delay time
+                if (delayFadeLength > 0)
+                {
+                    readDelayed (mDelayFadeBuffer, mFadeFromDelay);
+
+                    auto* output = tempBuffer.getWritePointer (channel);
+                    const auto* previous = mDelayFadeBuffer.getReadPointer (channel);
+                    const auto done = mDelayFadeLength - mDelayFade;
+                    for (int i = 0; i < delayFadeLength; ++i)
+                    {
+                        const auto gain = static_cast<float> (done + i + 1) / static_cast<float> (mDelayFadeLength + 1);
+                        output[i] = previous[i] + gain * (output[i] - previous[i]);
+                    }
+                }
+            }
+            // apply feedback
+            if (shimmerActive)
+            {
+                // (1 - shimmer) of the delayed signal, shimmer of its shifted copy
+                auto* shimmerData = mShimmerBuffer.getWritePointer (channel);
+                mShimmer.process (channel, tempBuffer.getReadPointer (channel), shimmerData, bufferLength);
+                juce::FloatVectorOperations::multiply (shimmerData, shimmer, bufferLength);
+                juce::FloatVectorOperations::addWithMultiply (shimmerData, tempBuffer.getReadPointer (channel), 1.0f - shimmer, bufferLength);
+                feedbackDelay (channel, bufferLength, shimmerData, startGain, endGain);
+            }
+            else
+            {
+                feedbackDelay (channel, bufferLength, tempBuffer.getReadPointer (channel), startGain, endGain);
+            }
+
+            juce::FloatVectorOperations::copy (bufferData, tempBuffer.getReadPointer (channel), bufferLength);
+
+            // Just unfrozen, the loop fades out rather than stopping dead.
+            const auto unfreezeFadeLength = juce::jmin (bufferLength, mUnfreezeFade);
+            const auto* delayBufferData = mDelayBuffer.getReadPointer (channel);
+            for (int i = 0; i < unfreezeFadeLength; ++i)
+            {
+                const auto loopGain = static_cast<float> (mUnfreezeFade - i) / static_cast<float> (mLoopCrossfade + 1);
+                const auto loopSample = getFrozenSample (delayBufferData, (mLoopPosition + i) % mLoopLength);
+                bufferData[i] += loopGain * (loopSample - bufferData[i]);
+            }
+        };
+
+        if (mThreadPool != nullptr && bufferLength >= minParallelChunkSize)
+            mThreadPool->run (numChannels, processChannel);
+        else
+            for (int channel = 0; channel < numChannels; ++channel)
+                processChannel (channel);
+
+        mDelayFade -= delayFadeLength;
+
+        if (mUnfreezeFade > 0)
+        {
+            const auto unfreezeFadeLength = juce::jmin (bufferLength, mUnfreezeFade);
+            mLoopPosition = (mLoopPosition + unfreezeFadeLength) % mLoopLength;
+            mUnfreezeFade -= unfreezeFadeLength;
+        }
+
+        /* We read bufferLength values so we need to increment the write position
+         * so that, next time, we read once again bufferLength values but don't 
+         * overwrite the previously saved values.
+         */
+        mWritePosition += bufferLength;
+        mWritePosition %= delayBufferLength; // wrap around
+    }
+
+    mPreviousFeedback = mParameters.feedback;
+    mPreviousModDepth = modDepth;
+}
+
+bool Delay::resetIfUnhealthy()
+{
+    const auto delayBufferLength = mDelayBuffer.getNumSamples();
+    const auto firstLength = juce::jmin (mLastWriteLength, delayBufferLength - mLastWriteStart);
+
+    // Only the last block was written, the rest was checked before.
+    auto healthy = true;
+    for (int channel = 0; channel < mDelayBuffer.getNumChannels() && healthy; ++channel)
+    {
+        const auto* delayBufferData = mDelayBuffer.getReadPointer (channel);
+        healthy = HealthCheck::isHealthy (delayBufferData + mLastWriteStart, firstLength)
+               && HealthCheck::isHealthy (delayBufferData, mLastWriteLength - firstLength);
+    }
+
+    if (healthy)
+        return false;
+
+    mDelayBuffer.clear();
+    mGrains.reset();
+    mShimmer.reset();
+    mLoopPosition = 0;
+    mUnfreezeFade = 0;
+    return true;
 }
 
 void Delay::fillDelayBuffer (int channel, const int bufferLength, const float* bufferData)
@@ -79,18 +399,13 @@ void Delay::fillDelayBuffer (int channel, const int bufferLength, const float* b
     }
 }
 
-void Delay::getFromDelayBuffer (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength)
+void Delay::getFromDelayBuffer (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength, int delayInSamples)
 {
     const auto delayBufferLength = mDelayBuffer.getNumSamples();
     const auto delayBufferData = mDelayBuffer.getReadPointer (channel);
 
-    auto delayTime = mDelayTimeParameter->get();
-    int readPosition = 0; // The index from where we want to read data
-
-    // mSampleRate * (delayTime / 1000) -> conversion to an index of the delayTime to a time in milliseconds
-    mDelaySyncToggleParameter->get() ? // if user wants to sync to tempo
-        readPosition = static_cast<int> (delayBufferLength + mWritePosition - ((mSampleRate * (1000 * 60 / mCurrentBPM) / mDelaySyncChoicesLUT[mDelaySyncParameter->getIndex()]) / 1000)) % delayBufferLength
-                                     : readPosition = static_cast<int> (delayBufferLength + mWritePosition - (mSampleRate * delayTime / 1000)) % delayBufferLength;
+    // The index from where we want to read data
+    const int readPosition = (delayBufferLength + mWritePosition - delayInSamples) % delayBufferLength;
 
     // if we're in range
     if (bufferLength + readPosition < delayBufferLength)
@@ -105,25 +420,151 @@ void Delay::getFromDelayBuffer (juce::AudioBuffer<float>& buffer, int channel, c
     }
 }
 
-void Delay::feedbackDelay (int channel, const int bufferLength, const float* dryBuffer)
+void Delay::getFromDelayBufferModulated (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength, int delayInSamples, const float* lfo, float startDepth, float endDepth)
+{
+    const auto delayBufferLength = mDelayBuffer.getNumSamples();
+    const auto delayBufferData = mDelayBuffer.getReadPointer (channel);
+    auto* output = buffer.getWritePointer (channel);
+
+    const auto depthIncrement = (endDepth - startDepth) / static_cast<float> (bufferLength);
+
+    auto next = [delayBufferLength] (int index) { return index + 1 == delayBufferLength ? 0 : index + 1; };
+
+    for (int i = 0; i < bufferLength; ++i)
+    {
+        // How much longer than delayInSamples the delay is, between 0 and depth.
+        const auto depth = startDepth + depthIncrement * static_cast<float> (i);
+        const auto offset = juce::jmax (0.0f, 0.5f * depth * (1.0f + lfo[i]));
+        const auto wholeOffset = static_cast<int> (offset);
+        const auto t = 1.0f - (offset - static_cast<float> (wholeOffset));
+
+        // The read position lies between x1 and x2, t away from x1.
+        auto index = mWritePosition + i - delayInSamples - wholeOffset - 2;
+        if (index < 0)
+            index += delayBufferLength;
+
+        const auto x0 = delayBufferData[index];
+        index = next (index);
+        const auto x1 = delayBufferData[index];
+        index = next (index);
+        const auto x2 = delayBufferData[index];
+        index = next (index);
+        const auto x3 = delayBufferData[index];
+
+        // Catmull-Rom
+        const auto c1 = 0.5f * (x2 - x0);
+        const auto c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+        const auto c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+        output[i] = ((c3 * t + c2) * t + c1) * t + x1;
+    }
+}
+
+void Delay::readFrozenLoop (int channel, float* output, int numSamples, int position) const
 {
     const auto delayBufferLength = mDelayBuffer.getNumSamples();
+    const auto delayBufferData = mDelayBuffer.getReadPointer (channel);
+    const auto crossfadeStart = mLoopLength - mLoopCrossfade;
+
+    for (int i = 0; i < numSamples;)
+    {
+        if (position < crossfadeStart)
+        {
+            // Up to the crossfade, or to the end of the delay buffer, a plain copy
+            const auto index = (mLoopStart + position) % delayBufferLength;
+            const auto length = juce::jmin (numSamples - i, crossfadeStart - position, delayBufferLength - index);
+
+            juce::FloatVectorOperations::copy (output + i, delayBufferData + index, length);
+            i += length;
+            position += length;
+        }
+        else
+        {
+            output[i++] = getFrozenSample (delayBufferData, position);
+            if (++position == mLoopLength)
+                position = 0;
+        }
+    }
+}
+
+float Delay::getFrozenSample (const float* delayBufferData, int position) const
+{
+    const auto delayBufferLength = mDelayBuffer.getNumSamples();
+    const auto sample = delayBufferData[(mLoopStart + position) % delayBufferLength];
+
+    const auto crossfadeStart = mLoopLength - mLoopCrossfade;
+    if (position < crossfadeStart)
+        return sample;
 
-    auto& feedbackGain = *apvts.getRawParameterValue ("Delay Feedback");
+    // What came mLoopLength samples earlier leads straight into the start of the loop.
+    const auto before = delayBufferData[(mLoopStart + position - mLoopLength + delayBufferLength) % delayBufferLength];
+    const auto t = static_cast<float> (position - crossfadeStart) / static_cast<float> (mLoopCrossfade);
+    return sample + t * (before - sample);
+}
+
+void Delay::feedbackDelay (int channel, const int bufferLength, const float* dryBuffer, float startGain, float endGain)
+{
+    const auto delayBufferLength = mDelayBuffer.getNumSamples();
 
     if (bufferLength + mWritePosition < delayBufferLength)
     {
-        mDelayBuffer.addFromWithRamp (channel, mWritePosition, dryBuffer, bufferLength, feedbackGain, feedbackGain);
+        mDelayBuffer.addFromWithRamp (channel, mWritePosition, dryBuffer, bufferLength, startGain, endGain);
     }
     else
     {
         const int bufferRemaining = delayBufferLength - mWritePosition;
+        const auto splitGain = startGain + (endGain - startGain) * static_cast<float> (bufferRemaining) / static_cast<float> (bufferLength);
 
-        mDelayBuffer.addFromWithRamp (channel, bufferRemaining, dryBuffer, bufferRemaining, feedbackGain, feedbackGain);
-        mDelayBuffer.addFromWithRamp (channel, 0, dryBuffer, bufferLength - bufferRemaining, feedbackGain, feedbackGain);
+        mDelayBuffer.addFromWithRamp (channel, mWritePosition, dryBuffer, bufferRemaining, startGain, splitGain);
+        mDelayBuffer.addFromWithRamp (channel, 0, dryBuffer + bufferRemaining, bufferLength - bufferRemaining, splitGain, endGain);
     }
 }
 
+int Delay::getDelayInSamples() const
+{
+    // mSampleRate * (delayTime / 1000) -> conversion to an index of the delayTime to a time in milliseconds
+    if (mParameters.syncToggle) // if user wants to sync to tempo
+        return static_cast<int> ((mSampleRate * (1000 * 60 / mCurrentBPM) / mDelaySyncChoicesLUT[mParameters.syncIndex]) / 1000);
+
+    return static_cast<int> (mSampleRate * mParameters.timeMs / 1000);
+}
+
+Delay::Parameters Delay::dumpParametersFromAPVTS() const
+{
+    Parameters tempParams;
+    tempParams.timeMs     = mDelayTimeParameter->get();
+    tempParams.feedback   = mDelayFeedbackParameter->get();
+    tempParams.syncToggle = mDelaySyncToggleParameter->get();
+    tempParams.syncIndex  = mDelaySyncParameter->getIndex();
+
+    tempParams.modRate    = mModRateParameter->get();
+    tempParams.modDepthMs = mModDepthParameter->get();
+    tempParams.modShape   = mModShapeParameter->getIndex();
+    tempParams.modStereo  = mModStereoParameter->get();
+
+    tempParams.mode                  = mModeParameter->getIndex();
+    tempParams.grainSizeMs           = mGrainSizeParameter->get();
+    tempParams.grainDensity          = mGrainDensityParameter->get();
+    tempParams.grainPitchJitter      = mGrainPitchJitterParameter->get();
+    tempParams.grainPositionJitterMs = mGrainPositionJitterParameter->get();
+
+    tempParams.shimmer      = mShimmerParameter->get();
+    tempParams.shimmerPitch = mShimmerPitchParameter->getIndex();
+
+    return tempParams;
+}
+
+void Delay::setParameters (const Parameters& newParameters)
+{
+    // process() ramps from mPreviousFeedback, where the last block ended.
+    mParameters = newParameters;
+    mParameters.timeMs = juce::jlimit (1, 2000, mParameters.timeMs);
+    mParameters.syncIndex = juce::jlimit (0, mDelaySyncChoicesLUT.size() - 1, mParameters.syncIndex);
+    mParameters.modShape = juce::jlimit (0, mModShapeParameter->choices.size() - 1, mParameters.modShape);
+    mParameters.mode = juce::jlimit (0, mModeParameter->choices.size() - 1, mParameters.mode);
+    mParameters.grainDensity = juce::jlimit (1, GrainEngine::maxGrains / 2, mParameters.grainDensity);
+    mParameters.shimmerPitch = juce::jlimit (0, mShimmerRatiosLUT.size() - 1, mParameters.shimmerPitch);
+}
+
 juce::AudioBuffer<float>& Delay::getDelayBuffer()
 {
     return mDelayBuffer;
@@ -140,4 +581,40 @@ void Delay::AppendToParameterLayout (juce::AudioProcessorValueTreeState::Paramet
     juce::StringArray choices = { "1:16", "1:12", "1:8", "1:6", "1:4", "1:3", "1:2", "1:1" };
 
     layout.add (std::make_unique<juce::AudioParameterChoice> ("Delay Sync", "Delay Sync", choices, choices.size() - 1));
+
+    // Modulation of the read head, a depth of 0 turns it off
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Mod Rate", "Delay Mod Rate", juce::NormalisableRange<float> (0.05f, 10.0f, 0.01f, 0.4f), 0.5f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Mod Depth", "Delay Mod Depth", juce::NormalisableRange<float> (0.0f, maxModDepthMs, 0.01f, 0.5f), 0.0f));
+
+    juce::StringArray shapes = { "Sine", "Triangle", "Tape" };
+
+    layout.add (std::make_unique<juce::AudioParameterChoice> ("Delay Mod Shape", "Delay Mod Shape", shapes, 0));
+
+    // phase offset between the channels' LFOs, in degrees
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Mod Stereo", "Delay Mod Stereo", juce::NormalisableRange<float> (0.0f, 180.0f, 1.0f), 90.0f));
+
+    // Grains instead of the read head, in the same order as Delay::Mode
+    juce::StringArray modes = { "Normal", "Reverse", "Granular" };
+
+    layout.add (std::make_unique<juce::AudioParameterChoice> ("Delay Mode", "Delay Mode", modes, 0));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Grain Size", "Delay Grain Size", juce::NormalisableRange<float> (10.0f, GrainEngine::maxGrainSizeMs, 1.0f, 0.5f), 100.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterInt> ("Delay Grain Density", "Delay Grain Density", 1, GrainEngine::maxGrains / 2, 4));
+
+    // in semitones, either way
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Grain Pitch Jitter", "Delay Grain Pitch Jitter", juce::NormalisableRange<float> (0.0f, GrainEngine::maxPitchJitter, 0.01f), 0.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Grain Position Jitter", "Delay Grain Position Jitter", juce::NormalisableRange<float> (0.0f, GrainEngine::maxPositionJitterMs, 1.0f, 0.5f), 0.0f));
+
+    // how much of the feedback is pitch shifted, 0 turns the shimmer off
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Delay Shimmer", "Delay Shimmer", juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f), 0.0f));
+
+    juce::StringArray intervals = { "+12", "+7", "-12" };
+
+    layout.add (std::make_unique<juce::AudioParameterChoice> ("Delay Shimmer Pitch", "Delay Shimmer Pitch", intervals, 0));
+
+    // Loops over the last delay, input and feedback are ignored while frozen
+    layout.add (std::make_unique<juce::AudioParameterBool> ("Delay Freeze", "Delay Freeze", false));
 }
\ No newline at end of file
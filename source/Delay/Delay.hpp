@@ -6,9 +6,41 @@
 #include "juce_dsp/juce_dsp.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 
+#include "GrainEngine.hpp"
+#include "LfoBank.hpp"
+#include "PitchShifter.hpp"
+
+class RenderThreadPool;
+
 class Delay
 {
 public:
+    /**
+     * @brief Holds the values the delay works with during a block.
+     *        Mirrors juce::dsp::Reverb::Parameters.
+     */
+    struct Parameters
+    {
+        int   timeMs     = 500;   // Delay Time
+        float feedback   = 0.1f;  // Delay Feedback
+        bool  syncToggle = false; // Delay Sync Toggle
+        int   syncIndex  = 7;     // Delay Sync, index in the choices
+
+        float modRate    = 0.5f;  // Delay Mod Rate, in Hz
+        float modDepthMs = 0.0f;  // Delay Mod Depth
+        int   modShape   = 0;     // Delay Mod Shape, index in the choices
+        float modStereo  = 90.0f; // Delay Mod Stereo, in degrees
+
+        int   mode                  = 0;      // Delay Mode, index in the choices
+        float grainSizeMs           = 100.0f; // Delay Grain Size
+        int   grainDensity          = 4;      // Delay Grain Density
+        float grainPitchJitter      = 0.0f;   // Delay Grain Pitch Jitter
+        float grainPositionJitterMs = 0.0f;   // Delay Grain Position Jitter
+
+        float shimmer      = 0.0f; // Delay Shimmer
+        int   shimmerPitch = 0;    // Delay Shimmer Pitch, index in the choices
+    };
+
     Delay(juce::AudioProcessorValueTreeState& valueTree);
 
     /**
@@ -19,7 +51,9 @@ public:
     void setSampleRate(int rate);
 
     /**
-     * @brief To be called inside the PluginProcessor::prepareToPlay method
+     * @brief To be called inside the PluginProcessor::prepareToPlay method.
+     *        Sizes the delay buffer, keeping what it holds: as it is when the
+     *        buffer is already big enough, resampled when the sample rate changed.
      * 
      * @param numInputChannels the total number of input channels
      * @param sampleRate the current sample rate
@@ -35,11 +69,27 @@ public:
     void prepare(const juce::dsp::ProcessSpec& specs);
 
     /**
-     * @brief To be called within PluginProcessor::processBlock method
-     *        /!\ (STILL NOT WORKING YET) /!\ 
+     * @brief Clears the delay buffer, the grains, the shimmer and the LFOs,
+     *        for a start from silence. prepare() doesn't.
+     */
+    void reset();
+
+    /**
+     * @brief To be called within PluginProcessor::processBlock method,
+     *        after setParameters(). Blocks may have any size up to the
+     *        maximumBlockSize given to prepare().
      */
     void process(juce::dsp::ProcessContextReplacing<float>& context);
 
+    /**
+     * @brief Checks what the last process() wrote to the delay buffer. If any of
+     *        it is NaN, infinite or running away, clears the delay's state: the
+     *        buffer, the grains, the shimmer and the frozen loop.
+     *
+     * @return true if the state was cleared, the output of the last process() is bad too.
+     */
+    bool resetIfUnhealthy();
+
     /**
      * @brief the read operation of a DDL. Reads the content of the AudioBuffer
      *        given by JUCE and copy its content to the DDL's circular buffer.
@@ -56,17 +106,42 @@ public:
      * @param buffer a reference to the main buffer given in processBlock
      * @param channel the channel of buffer to process
      * @param bufferLength the length of the buffer, buffer
+     * @param delayInSamples how far behind the write position to read
      */
-    void getFromDelayBuffer (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength);
+    void getFromDelayBuffer (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength, int delayInSamples);
     
+    /**
+     * @brief Same as getFromDelayBuffer(), with the read head pushed further
+     *        back by up to depth samples following the LFO, and the
+     *        delay buffer read between samples (cubic Hermite).
+     *
+     * @param buffer where to write the delayed samples
+     * @param channel the channel of buffer to process
+     * @param bufferLength the number of samples to read
+     * @param delayInSamples how far behind the write position to read, without the modulation
+     * @param lfo bufferLength values of the channel's LFO, in [-1, 1]
+     * @param startDepth the modulation depth at the first sample, in samples
+     * @param endDepth the modulation depth after the last sample, in samples
+     */
+    void getFromDelayBufferModulated (juce::AudioBuffer<float>& buffer, int channel, const int bufferLength, int delayInSamples, const float* lfo, float startDepth, float endDepth);
+
+    /**
+     * @brief Frozen, the delay loops over the delayInSamples samples it last wrote.
+     *        Reads numSamples samples of the loop of a channel into output, from
+     *        position in the loop.
+     */
+    void readFrozenLoop (int channel, float* output, int numSamples, int position) const;
+
     /**
      * @brief adds feedback to the DDL
      * 
      * @param channel the channel of buffer to process
      * @param bufferLength the length of the main buffer
      * @param dryBuffer a writePointer to the main buffer
+     * @param startGain the feedback gain at the first sample
+     * @param endGain the feedback gain after the last sample
      */
-    void feedbackDelay (int channel, const int bufferLength, const float* dryBuffer);
+    void feedbackDelay (int channel, const int bufferLength, const float* dryBuffer, float startGain, float endGain);
 
     /**
      * @brief Get the Delay Buffer 
@@ -82,6 +157,27 @@ public:
      */
     void AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
 
+    /**
+     * @brief dumps the values of the delay's parameters from the APVTS.
+     *
+     * @return Delay::Parameters
+     */
+    Parameters dumpParametersFromAPVTS() const;
+
+    /**
+     * @brief Sets the values used by the next process(), all but the freeze
+     *        which isn't part of a preset. To be called once per block, either with
+     *        dumpParametersFromAPVTS() or with values computed elsewhere
+     *        (e.g. by the PresetMorph).
+     */
+    void setParameters(const Parameters& newParameters);
+
+    /**
+     * @brief The distance between the write and the read positions,
+     *        from the parameters set by the last call to setParameters().
+     */
+    int getDelayInSamples() const;
+
     /**
      * @brief sets the tempo for the delay. Used within the context of sync.
      * 
@@ -89,10 +185,23 @@ public:
      */
     void setBPM(int BPM) {mCurrentBPM = BPM; }
 
+    /**
+     * @brief Lets process() share the channels of long chunks out between
+     *        the pool's threads, nullptr to process them one after the other.
+     *        The output is the same either way.
+     */
+    void setThreadPool(RenderThreadPool* pool) { mThreadPool = pool; }
+
     int mWritePosition = 0;
 
 
 private:
+    /**
+     * @brief Fills the (cleared) delay buffer with what previous held, at the
+     *        current sample rate, and restarts the write position from 0.
+     */
+    void resampleFrom (const juce::AudioBuffer<float>& previous, double previousSampleRate);
+
     juce::AudioBuffer<float> mDelayBuffer, tempBuffer;
     juce::AudioProcessorValueTreeState& apvts;
 
@@ -100,17 +209,91 @@ private:
     juce::AudioParameterFloat* mDelayFeedbackParameter = nullptr;
     juce::AudioParameterBool* mDelaySyncToggleParameter = nullptr;
     juce::AudioParameterChoice* mDelaySyncParameter = nullptr;
+    juce::AudioParameterFloat* mModRateParameter = nullptr;
+    juce::AudioParameterFloat* mModDepthParameter = nullptr;
+    juce::AudioParameterChoice* mModShapeParameter = nullptr;
+    juce::AudioParameterFloat* mModStereoParameter = nullptr;
+    juce::AudioParameterChoice* mModeParameter = nullptr;
+    juce::AudioParameterFloat* mGrainSizeParameter = nullptr;
+    juce::AudioParameterInt* mGrainDensityParameter = nullptr;
+    juce::AudioParameterFloat* mGrainPitchJitterParameter = nullptr;
+    juce::AudioParameterFloat* mGrainPositionJitterParameter = nullptr;
+    juce::AudioParameterFloat* mShimmerParameter = nullptr;
+    juce::AudioParameterChoice* mShimmerPitchParameter = nullptr;
+    juce::AudioParameterBool* mFreezeParameter = nullptr;
 
     juce::dsp::IIR::Filter<float> filter;
 
+    Parameters mParameters;
+    float mPreviousFeedback = 0.1f; // where the feedback ramp of the last block ended
+
+    // A new delay time crossfades the read head over from the old one rather than
+    // jumping there. Automation and the preset morph change it every block, in whole
+    // milliseconds: changes during a crossfade wait for it to end.
+    static constexpr double delayFadeSeconds = 0.02;
+    juce::AudioBuffer<float> mDelayFadeBuffer; // what the old read head reads
+    int mReadDelay = 0;                        // in samples, where the read head is, 0 until the first block
+    int mFadeFromDelay = 0;                    // in samples, where it's fading from
+    int mDelayFade = 0;                        // samples left of the crossfade
+    int mDelayFadeLength = 1;
+
+    // Chorus, flanger and tape wow/flutter: the read head moves
+    // between the delay time and the delay time + depth.
+    static constexpr float maxModDepthMs = 20.0f;
+    LfoBank mLfo;
+    juce::AudioBuffer<float> mModulationBuffer;
+    float mPreviousModDepth = 0.0f; // in samples, where the depth ramp of the last block ended
+
+    // The "Delay Mode" choices. In the reverse and granular modes
+    // the grains replace the read head.
+    enum Mode
+    {
+        normalMode,
+        reverseMode,
+        granularMode
+    };
+
+    GrainEngine mGrains;
+    int mPreviousMode = normalMode;
+
+    // Shimmer: part of the feedback goes through the pitch shifter.
+    PitchShifter mShimmer;
+    juce::AudioBuffer<float> mShimmerBuffer;
+    bool mShimmerWasActive = false;
+
+    /**
+     * @brief The sample of the frozen loop at position, crossfaded, near
+     *        the end of the loop, with what came before its start.
+     */
+    float getFrozenSample (const float* delayBufferData, int position) const;
+
+    // Freeze: no writes, the read head loops over the last delay. The loop
+    // keeps its length whatever happens to the delay time while frozen.
+    bool mFrozen = false;
+    int mLoopStart = 0, mLoopLength = 1, mLoopPosition = 0;
+    int mLoopCrossfade = 1;  // in samples, at the end of the loop
+    int mUnfreezeFade = 0;   // samples left of the loop fading out after unfreezing
+
+    juce::Array<float> mShimmerRatiosLUT = { 2.0f, 1.4983071f, 0.5f }; // +12, +7 and -12 semitones
+
     
     juce::Array<int> mDelaySyncChoicesLUT = {16, 12,
                                              8,  6,  4,
                                              3,  2,  1};
     
+    // What the last process() wrote, for resetIfUnhealthy()
+    int mLastWriteStart = 0, mLastWriteLength = 0;
+
+    // Shorter chunks aren't worth waking a thread for.
+    static constexpr int minParallelChunkSize = 2048;
+    RenderThreadPool* mThreadPool = nullptr;
+
     int mSampleRate = 44100;
     int mCurrentBPM = 120; // is set by setBPM within PluginProcessor::processBlock()
 
+    // Defined in the tests, see PluginProcessor.
+    friend struct StateRecoveryTestAccess;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Delay)
 };
 
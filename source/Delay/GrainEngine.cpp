@@ -0,0 +1,173 @@
+#include "GrainEngine.hpp"
+#include <algorithm>
+#include <cmath>
+
+int GrainEngine::getMaxExtraDelayInSamples (double sampleRate)
+{
+    // Granular: the position jitter, plus a grain pitched an octave up
+    // starting a whole grain further back. Reverse: two grains.
+    const auto extraMs = juce::jmax (maxPositionJitterMs + maxGrainSizeMs, 2.0f * maxGrainSizeMs);
+    return static_cast<int> (std::ceil (extraMs * sampleRate / 1000.0)) + 2;
+}
+
+const std::array<float, GrainEngine::windowSize>& GrainEngine::getWindowTable()
+{
+    static const auto table = []()
+    {
+        std::array<float, windowSize> window;
+        for (size_t i = 0; i < window.size(); ++i)
+            window[i] = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi * static_cast<float> (i) / static_cast<float> (windowSize));
+        return window;
+    }();
+
+    return table;
+}
+
+void GrainEngine::prepare (double sampleRate, int maximumBlockSize)
+{
+    mSampleRate = sampleRate;
+    mWindow = &getWindowTable();
+
+    if (maximumBlockSize > mMaximumBlockSize)
+    {
+        mGrainScratch.allocate (static_cast<size_t> (maximumBlockSize), true);
+        mWindowScratch.allocate (static_cast<size_t> (maximumBlockSize), true);
+        mMaximumBlockSize = maximumBlockSize;
+    }
+
+    reset();
+}
+
+void GrainEngine::reset()
+{
+    for (auto& grain : mGrains)
+        grain.active = false;
+
+    // Same seed every time, so that a render is reproducible.
+    mRandom.setSeed (0x6e41);
+    mSamplesUntilNextGrain = 0;
+}
+
+void GrainEngine::setParameters (Mode newMode, const Parameters& newParameters, int delayInSamples)
+{
+    mMode = newMode;
+    mParameters = newParameters;
+    mParameters.pitchJitter = juce::jlimit (0.0f, maxPitchJitter, mParameters.pitchJitter);
+    mParameters.positionJitterMs = juce::jlimit (0.0f, maxPositionJitterMs, mParameters.positionJitterMs);
+    mDelayInSamples = delayInSamples;
+
+    const auto grainSizeMs = juce::jlimit (1.0f, maxGrainSizeMs, mParameters.grainSizeMs);
+    mGrainLength = juce::jmax (1, juce::roundToInt (grainSizeMs * mSampleRate / 1000.0));
+
+    // Two reversed grains overlapping by half add up to exactly 1.
+    const auto density = mMode == Mode::reverse ? 2 : juce::jlimit (1, maxGrains / 2, mParameters.density);
+    mGrainInterval = juce::jmax (1, mGrainLength / density);
+
+    // A Hann window averages 0.5.
+    mGain = 2.0f / static_cast<float> (juce::jmax (2, density));
+}
+
+void GrainEngine::process (const juce::AudioBuffer<float>& delayBuffer, int writePosition, juce::AudioBuffer<float>& output, int numChannels, int numSamples)
+{
+    jassert (numSamples <= mMaximumBlockSize);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::clear (output.getWritePointer (channel), numSamples);
+
+    const auto delayBufferLength = delayBuffer.getNumSamples();
+
+    for (int start = 0; start < numSamples;)
+    {
+        if (mSamplesUntilNextGrain <= 0)
+        {
+            startGrain ((writePosition + start) % delayBufferLength, delayBufferLength);
+            mSamplesUntilNextGrain = mGrainInterval;
+        }
+
+        // Up to the start of the next grain
+        const auto length = juce::jmin (numSamples - start, mSamplesUntilNextGrain);
+
+        for (auto& grain : mGrains)
+            if (grain.active)
+                renderGrain (grain, delayBuffer, output, numChannels, start, length);
+
+        mSamplesUntilNextGrain -= length;
+        start += length;
+    }
+}
+
+void GrainEngine::startGrain (int writePosition, int delayBufferLength)
+{
+    // The pool is full: this one is dropped.
+    auto grain = std::find_if (mGrains.begin(), mGrains.end(), [] (const Grain& g) { return !g.active; });
+    if (grain == mGrains.end())
+        return;
+
+    grain->active = true;
+    grain->age = 0;
+    grain->length = mGrainLength;
+
+    double distance = mDelayInSamples + 1;
+
+    if (mMode == Mode::reverse)
+    {
+        grain->step = -1.0;
+    }
+    else
+    {
+        const auto semitones = mParameters.pitchJitter * (2.0f * mRandom.nextFloat() - 1.0f);
+        grain->step = std::pow (2.0, semitones / 12.0);
+
+        distance += mParameters.positionJitterMs * mSampleRate / 1000.0 * mRandom.nextDouble();
+
+        // A grain faster than the write head starts far enough back not to catch up with it.
+        distance += juce::jmax (0.0, (grain->step - 1.0) * grain->length);
+    }
+
+    grain->position = writePosition - distance;
+    while (grain->position < 0.0)
+        grain->position += delayBufferLength;
+}
+
+void GrainEngine::renderGrain (Grain& grain, const juce::AudioBuffer<float>& delayBuffer, juce::AudioBuffer<float>& output, int numChannels, int offset, int numSamples)
+{
+    const auto count = juce::jmin (numSamples, grain.length - grain.age);
+    const auto delayBufferLength = delayBuffer.getNumSamples();
+    const auto length = static_cast<double> (delayBufferLength);
+
+    // The window is shared by every channel.
+    const auto& window = *mWindow;
+    const auto windowStep = static_cast<float> (windowSize) / static_cast<float> (grain.length);
+    for (int i = 0; i < count; ++i)
+    {
+        const auto index = juce::jmin (windowSize - 1, static_cast<int> (static_cast<float> (grain.age + i) * windowStep));
+        mWindowScratch[i] = mGain * window[static_cast<size_t> (index)];
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* data = delayBuffer.getReadPointer (channel);
+        auto position = grain.position;
+
+        // Gathered with a linear interpolation, then windowed and mixed in one pass.
+        for (int i = 0; i < count; ++i)
+        {
+            const auto index = static_cast<int> (position);
+            const auto fraction = static_cast<float> (position - index);
+            const auto next = index + 1 == delayBufferLength ? 0 : index + 1;
+            mGrainScratch[i] = data[index] + fraction * (data[next] - data[index]);
+
+            position += grain.step;
+            if (position >= length)
+                position -= length;
+            else if (position < 0.0)
+                position += length;
+        }
+
+        juce::FloatVectorOperations::addWithMultiply (output.getWritePointer (channel, offset), mGrainScratch.get(), mWindowScratch.get(), count);
+    }
+
+    grain.position = std::fmod (grain.position + grain.step * count + length, length);
+    grain.age += count;
+    grain.active = grain.age < grain.length;
+}
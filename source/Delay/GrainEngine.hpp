@@ -0,0 +1,129 @@
+#ifndef GRAINENGINE_HPP
+#define GRAINENGINE_HPP
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+#include <array>
+
+/**
+ * @brief Reads windowed grains out of the delay buffer and overlap-adds them,
+ *        for the reverse and granular modes of the Delay.
+ *
+ *        Grains live in a fixed pool, a new grain is dropped when the pool
+ *        is full. Each grain is gathered into a scratch buffer, then mixed
+ *        with its window (from a table shared by every instance) in one
+ *        vectorised multiply-add.
+ *
+ *        A grain never reads closer than delayInSamples + 1 to the sample
+ *        being written, so that, like the plain delay, it only reads samples
+ *        of previous chunks as long as chunks are shorter than the delay.
+ */
+class GrainEngine
+{
+public:
+    enum class Mode
+    {
+        reverse,  // the last grainSize samples, one delay ago, backwards
+        granular  // grains with jittered position and pitch
+    };
+
+    struct Parameters
+    {
+        float grainSizeMs        = 100.0f;
+        int   density            = 4;     // grains overlapping at any time
+        float pitchJitter        = 0.0f;  // in semitones, either way
+        float positionJitterMs   = 0.0f;  // how much further back a grain may start
+    };
+
+    static constexpr float maxGrainSizeMs = 500.0f;
+    static constexpr float maxPositionJitterMs = 500.0f;
+    static constexpr float maxPitchJitter = 12.0f;
+    static constexpr int maxGrains = 64;
+
+    GrainEngine() = default;
+
+    /**
+     * @brief The furthest behind delayInSamples a grain may read.
+     *        The delay buffer has to be that much longer.
+     */
+    static int getMaxExtraDelayInSamples (double sampleRate);
+
+    /**
+     * @brief To be called inside the owner's prepare method.
+     *
+     * @param sampleRate the current sample rate
+     * @param maximumBlockSize the largest numSamples given to process()
+     */
+    void prepare (double sampleRate, int maximumBlockSize);
+
+    /**
+     * @brief Stops every grain and restarts the scheduler and the jitter.
+     */
+    void reset();
+
+    /**
+     * @brief To be called before process(), usually once per block.
+     */
+    void setParameters (Mode newMode, const Parameters& newParameters, int delayInSamples);
+
+    /**
+     * @brief Writes the next numSamples samples of the grains to output,
+     *        starting at its first sample.
+     *
+     * @param delayBuffer the delay line the grains read from
+     * @param writePosition where the first of these samples is written in delayBuffer
+     * @param output where to write the grains, overwritten
+     * @param numChannels the channels to process in both buffers
+     * @param numSamples at most the maximumBlockSize given to prepare()
+     */
+    void process (const juce::AudioBuffer<float>& delayBuffer, int writePosition, juce::AudioBuffer<float>& output, int numChannels, int numSamples);
+
+private:
+    struct Grain
+    {
+        bool   active   = false;
+        double position = 0.0; // in the delay buffer
+        double step     = 1.0; // the pitch ratio, -1 when reversed
+        int    age      = 0;
+        int    length   = 0;
+    };
+
+    static constexpr int windowSize = 2048;
+
+    /**
+     * @brief A periodic Hann window, computed once for every instance.
+     */
+    static const std::array<float, windowSize>& getWindowTable();
+
+    /**
+     * @brief Starts a grain, if the pool has room for it.
+     *
+     * @param writePosition where the sample at which the grain starts is written.
+     */
+    void startGrain (int writePosition, int delayBufferLength);
+
+    /**
+     * @brief Adds the next numSamples samples of grain to output, from offset.
+     */
+    void renderGrain (Grain& grain, const juce::AudioBuffer<float>& delayBuffer, juce::AudioBuffer<float>& output, int numChannels, int offset, int numSamples);
+
+    std::array<Grain, maxGrains> mGrains;
+    const std::array<float, windowSize>* mWindow = nullptr;
+    juce::HeapBlock<float> mGrainScratch, mWindowScratch;
+    int mMaximumBlockSize = 0;
+
+    juce::Random mRandom;
+    int mSamplesUntilNextGrain = 0;
+
+    Mode mMode = Mode::granular;
+    Parameters mParameters;
+    int mDelayInSamples = 0;
+    int mGrainLength = 1;    // in samples
+    int mGrainInterval = 1;  // between the starts of two grains, in samples
+    float mGain = 1.0f;      // makes up for the overlap
+    double mSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GrainEngine)
+};
+
+#endif
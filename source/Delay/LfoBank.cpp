@@ -0,0 +1,169 @@
+#include "LfoBank.hpp"
+#include <cmath>
+
+namespace
+{
+    double wrapPhase (double phase)
+    {
+        return phase - std::floor (phase);
+    }
+}
+
+void LfoBank::prepare (double sampleRate, int maximumBlockSize)
+{
+    mSampleRate = sampleRate;
+
+    if (maximumBlockSize > mMaximumBlockSize)
+    {
+        mScratch.allocate (static_cast<size_t> (maximumBlockSize), true);
+        mMaximumBlockSize = maximumBlockSize;
+    }
+
+    reset();
+}
+
+void LfoBank::reset()
+{
+    mPhase = 0.0;
+    mFlutterPhase = 0.0;
+}
+
+void LfoBank::setParameters (float rateHz, Shape newShape, float stereoPhase)
+{
+    mIncrement = static_cast<double> (rateHz) / mSampleRate;
+    mShape = newShape;
+    mStereoPhase = static_cast<double> (stereoPhase);
+}
+
+void LfoBank::process (float* const* outputs, int numChannels, int numSamples)
+{
+    jassert (numSamples <= mMaximumBlockSize);
+
+    const auto increment = static_cast<float> (mIncrement);
+    const auto flutterIncrement = static_cast<float> (mIncrement * flutterRatio);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* output = outputs[channel];
+        const auto offset = mStereoPhase * channel;
+
+        fillPhases (output, static_cast<float> (wrapPhase (mPhase + offset)), increment, numSamples);
+
+        switch (mShape)
+        {
+            case Shape::sine:
+                shapeSine (output, numSamples);
+                break;
+
+            case Shape::triangle:
+                shapeTriangle (output, numSamples);
+                break;
+
+            case Shape::tape:
+                shapeSine (output, numSamples);
+                fillPhases (mScratch, static_cast<float> (wrapPhase (mFlutterPhase + offset)), flutterIncrement, numSamples);
+                shapeSine (mScratch, numSamples);
+                juce::FloatVectorOperations::multiply (output, wowAmount, numSamples);
+                juce::FloatVectorOperations::addWithMultiply (output, mScratch.get(), flutterAmount, numSamples);
+                break;
+        }
+    }
+
+    mPhase = wrapPhase (mPhase + mIncrement * numSamples);
+    mFlutterPhase = wrapPhase (mFlutterPhase + mIncrement * flutterRatio * numSamples);
+}
+
+float LfoBank::approximateSine (float phase)
+{
+    // sin (2 pi phase) = -sin (2 pi x), x in [-0.5, 0.5): a parabola
+    // through the zeros and the peaks, refined once.
+    const auto x = phase - 0.5f;
+    auto y = 8.0f * x - 16.0f * x * std::abs (x);
+    y += 0.225f * (y * std::abs (y) - y);
+    return -y;
+}
+
+void LfoBank::fillPhases (float* destination, float phase, float increment, int numSamples)
+{
+    int i = 0;
+
+#if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr auto vecSize = static_cast<int> (Vec::size());
+
+    while (i < numSamples && !Vec::isSIMDAligned (destination + i))
+    {
+        const auto p = phase + increment * static_cast<float> (i);
+        destination[i] = p - std::floor (p);
+        ++i;
+    }
+
+    if (i + vecSize <= numSamples)
+    {
+        // Each vector starts again from its wrapped first phase rather than
+        // accumulating, so that no rounding error builds up along the block.
+        jassert (increment * static_cast<float> (vecSize) < 1.0f);
+
+        Vec ramp;
+        for (size_t lane = 0; lane < Vec::size(); ++lane)
+            ramp.set (lane, increment * static_cast<float> (lane));
+
+        const auto one = Vec::expand (1.0f);
+
+        for (; i + vecSize <= numSamples; i += vecSize)
+        {
+            const auto p = phase + increment * static_cast<float> (i);
+            auto lanes = Vec::expand (p - std::floor (p)) + ramp;
+            lanes -= one & Vec::greaterThanOrEqual (lanes, one);
+            lanes.copyToRawArray (destination + i);
+        }
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+    {
+        const auto p = phase + increment * static_cast<float> (i);
+        destination[i] = p - std::floor (p);
+    }
+}
+
+void LfoBank::shapeSine (float* data, int numSamples)
+{
+    int i = 0;
+
+#if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr auto vecSize = static_cast<int> (Vec::size());
+
+    while (i < numSamples && !Vec::isSIMDAligned (data + i))
+    {
+        data[i] = approximateSine (data[i]);
+        ++i;
+    }
+
+    const auto half = Vec::expand (0.5f);
+    const auto eight = Vec::expand (8.0f), sixteen = Vec::expand (16.0f);
+    const auto refinement = Vec::expand (0.225f);
+    const auto zero = Vec::expand (0.0f);
+
+    for (; i + vecSize <= numSamples; i += vecSize)
+    {
+        const auto x = Vec::fromRawArray (data + i) - half;
+        auto y = eight * x - sixteen * x * Vec::abs (x);
+        y += refinement * (y * Vec::abs (y) - y);
+        (zero - y).copyToRawArray (data + i);
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        data[i] = approximateSine (data[i]);
+}
+
+void LfoBank::shapeTriangle (float* data, int numSamples)
+{
+    // 4 |phase - 0.5| - 1
+    juce::FloatVectorOperations::add (data, -0.5f, numSamples);
+    juce::FloatVectorOperations::abs (data, data, numSamples);
+    juce::FloatVectorOperations::multiply (data, 4.0f, numSamples);
+    juce::FloatVectorOperations::add (data, -1.0f, numSamples);
+}
@@ -0,0 +1,94 @@
+#ifndef LFOBANK_HPP
+#define LFOBANK_HPP
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+
+/**
+ * @brief One LFO per channel, sharing rate and shape, each channel
+ *        offset in phase from the previous one.
+ *
+ *        Values are generated a block at a time: the phases are laid
+ *        out by a SIMD accumulator, then shaped in place with a
+ *        polynomial sine (no std::sin), so that the cost per sample
+ *        stays a handful of multiply-adds.
+ */
+class LfoBank
+{
+public:
+    enum class Shape
+    {
+        sine,
+        triangle,
+        tape // slow wow plus a faster, smaller flutter
+    };
+
+    LfoBank() = default;
+
+    /**
+     * @brief To be called inside the owner's prepare method.
+     *
+     * @param sampleRate the current sample rate
+     * @param maximumBlockSize the largest numSamples given to process()
+     */
+    void prepare (double sampleRate, int maximumBlockSize);
+
+    /**
+     * @brief Restarts every LFO from phase 0.
+     */
+    void reset();
+
+    /**
+     * @brief To be called before process(), usually once per block.
+     *
+     * @param rateHz the frequency of the LFOs
+     * @param newShape the waveform
+     * @param stereoPhase the phase offset between two consecutive channels, in turns (0 to 1)
+     */
+    void setParameters (float rateHz, Shape newShape, float stereoPhase);
+
+    /**
+     * @brief Writes the next numSamples values, between -1 and 1,
+     *        of each LFO to outputs[channel], then moves on.
+     */
+    void process (float* const* outputs, int numChannels, int numSamples);
+
+    /**
+     * @brief sin (2 pi phase) for a phase in [0, 1), within 0.0011.
+     */
+    static float approximateSine (float phase);
+
+private:
+    /**
+     * @brief destination[i] = fractional part of (phase + i * increment),
+     *        with phase in [0, 1) and increment below 1 / the SIMD width.
+     */
+    static void fillPhases (float* destination, float phase, float increment, int numSamples);
+
+    /**
+     * @brief Replaces each phase by approximateSine (phase).
+     */
+    static void shapeSine (float* data, int numSamples);
+
+    /**
+     * @brief Replaces each phase by a triangle starting at 1.
+     */
+    static void shapeTriangle (float* data, int numSamples);
+
+    static constexpr double flutterRatio = 6.3; // tape flutter, relative to the wow
+    static constexpr float wowAmount = 0.8f, flutterAmount = 0.2f;
+
+    juce::HeapBlock<float> mScratch; // the flutter of the tape shape
+    int mMaximumBlockSize = 0;
+
+    double mSampleRate = 44100.0;
+    double mPhase = 0.0, mFlutterPhase = 0.0; // of the first channel, in turns
+    double mIncrement = 0.0;                  // turns per sample
+    double mStereoPhase = 0.0;
+    Shape mShape = Shape::sine;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LfoBank)
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "PitchShifter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+const std::array<float, PitchShifter::fftSize>& PitchShifter::getWindowTable()
+{
+    static const auto table = []()
+    {
+        std::array<float, fftSize> window;
+        for (size_t i = 0; i < window.size(); ++i)
+            window[i] = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi * static_cast<float> (i) / static_cast<float> (fftSize));
+        return window;
+    }();
+
+    return table;
+}
+
+void PitchShifter::prepare (int numChannels)
+{
+    mWindow = &getWindowTable();
+
+    mChannels.resize (static_cast<size_t> (numChannels));
+    for (auto& channel : mChannels)
+    {
+        channel.inputFifo.resize (static_cast<size_t> (fftSize));
+        channel.outputFifo.resize (static_cast<size_t> (fftSize));
+        channel.outputAccumulator.resize (static_cast<size_t> (2 * fftSize));
+        channel.lastPhase.resize (static_cast<size_t> (numBins));
+        channel.sumPhase.resize (static_cast<size_t> (numBins));
+
+        if (channel.fft == nullptr)
+            channel.fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+
+        // the real only transforms work in place on 2 * fftSize floats
+        channel.fftData.resize (static_cast<size_t> (2 * fftSize));
+        channel.magnitudes.resize (static_cast<size_t> (numBins));
+        channel.frequencies.resize (static_cast<size_t> (numBins));
+        channel.shiftedMagnitudes.resize (static_cast<size_t> (numBins));
+        channel.shiftedFrequencies.resize (static_cast<size_t> (numBins));
+    }
+
+    reset();
+}
+
+void PitchShifter::reset()
+{
+    for (auto& channel : mChannels)
+    {
+        std::fill (channel.inputFifo.begin(), channel.inputFifo.end(), 0.0f);
+        std::fill (channel.outputFifo.begin(), channel.outputFifo.end(), 0.0f);
+        std::fill (channel.outputAccumulator.begin(), channel.outputAccumulator.end(), 0.0f);
+        std::fill (channel.lastPhase.begin(), channel.lastPhase.end(), 0.0f);
+        std::fill (channel.sumPhase.begin(), channel.sumPhase.end(), 0.0f);
+        channel.rover = getLatencyInSamples();
+    }
+}
+
+void PitchShifter::process (int channelIndex, const float* input, float* output, int numSamples)
+{
+    auto& channel = mChannels[static_cast<size_t> (channelIndex)];
+    constexpr auto latency = getLatencyInSamples();
+
+    for (int i = 0; i < numSamples;)
+    {
+        // Up to the next frame
+        const auto length = juce::jmin (numSamples - i, fftSize - channel.rover);
+
+        std::copy (input + i, input + i + length, channel.inputFifo.data() + channel.rover);
+        std::copy (channel.outputFifo.data() + channel.rover - latency, channel.outputFifo.data() + channel.rover - latency + length, output + i);
+
+        channel.rover += length;
+        i += length;
+
+        if (channel.rover == fftSize)
+        {
+            channel.rover = latency;
+            processFrame (channel);
+        }
+    }
+}
+
+void PitchShifter::processFrame (Channel& channel)
+{
+    constexpr auto twoPi = juce::MathConstants<float>::twoPi;
+    constexpr auto expectedPhaseIncrement = twoPi / static_cast<float> (overlap); // per bin, between two frames
+    const auto& window = *mWindow;
+
+    // Analysis
+    juce::FloatVectorOperations::multiply (channel.fftData.data(), channel.inputFifo.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::clear (channel.fftData.data() + fftSize, fftSize);
+    channel.fft->performRealOnlyForwardTransform (channel.fftData.data(), true);
+
+    auto* spectrum = reinterpret_cast<std::complex<float>*> (channel.fftData.data());
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto phase = std::arg (spectrum[k]);
+        auto deviation = phase - channel.lastPhase[static_cast<size_t> (k)] - static_cast<float> (k) * expectedPhaseIncrement;
+        channel.lastPhase[static_cast<size_t> (k)] = phase;
+        deviation -= twoPi * std::round (deviation / twoPi);
+
+        channel.magnitudes[static_cast<size_t> (k)] = std::abs (spectrum[k]);
+        channel.frequencies[static_cast<size_t> (k)] = static_cast<float> (k) + deviation / expectedPhaseIncrement; // in bins
+    }
+
+    // Shift: every bin moves to k * ratio, its frequency with it.
+    std::fill (channel.shiftedMagnitudes.begin(), channel.shiftedMagnitudes.end(), 0.0f);
+    std::fill (channel.shiftedFrequencies.begin(), channel.shiftedFrequencies.end(), 0.0f);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto target = static_cast<int> (static_cast<float> (k) * mRatio + 0.5f);
+        if (target >= numBins)
+            break;
+
+        channel.shiftedMagnitudes[static_cast<size_t> (target)] += channel.magnitudes[static_cast<size_t> (k)];
+        channel.shiftedFrequencies[static_cast<size_t> (target)] = channel.frequencies[static_cast<size_t> (k)] * mRatio;
+    }
+
+    // Synthesis, the phases advancing at each bin's new frequency
+    for (int k = 0; k < numBins; ++k)
+    {
+        auto& sumPhase = channel.sumPhase[static_cast<size_t> (k)];
+        sumPhase = std::remainder (sumPhase + channel.shiftedFrequencies[static_cast<size_t> (k)] * expectedPhaseIncrement, twoPi);
+        spectrum[k] = std::polar (channel.shiftedMagnitudes[static_cast<size_t> (k)], sumPhase);
+    }
+
+    juce::FloatVectorOperations::clear (channel.fftData.data() + 2 * numBins, 2 * fftSize - 2 * numBins);
+    channel.fft->performRealOnlyInverseTransform (channel.fftData.data());
+
+    // Hann windows at analysis and synthesis, overlapping 4 times, add up to 1.5.
+    juce::FloatVectorOperations::multiply (channel.fftData.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::addWithMultiply (channel.outputAccumulator.data(), channel.fftData.data(), 1.0f / 1.5f, fftSize);
+
+    // A hop is ready, the rest of the frame moves along.
+    std::copy (channel.outputAccumulator.begin(), channel.outputAccumulator.begin() + hopSize, channel.outputFifo.begin());
+    std::copy (channel.outputAccumulator.begin() + hopSize, channel.outputAccumulator.begin() + hopSize + fftSize, channel.outputAccumulator.begin());
+    std::copy (channel.inputFifo.begin() + hopSize, channel.inputFifo.end(), channel.inputFifo.begin());
+}
@@ -0,0 +1,90 @@
+#ifndef PITCHSHIFTER_HPP
+#define PITCHSHIFTER_HPP
+
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Streaming phase vocoder pitch shifter, for the shimmer in the
+ *        delay's feedback.
+ *
+ *        Samples go through one at a time, the FFT work only happens every
+ *        hopSize samples: one forward and one inverse transform of fftSize
+ *        per hop and per channel, whatever the block size. Every buffer is
+ *        allocated in prepare(). Channels share nothing but the window
+ *        table, they may be processed on different threads.
+ */
+class PitchShifter
+{
+public:
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int overlap = 4;
+    static constexpr int hopSize = fftSize / overlap;
+
+    PitchShifter() = default;
+
+    /**
+     * @brief How late the shifted signal is.
+     */
+    static constexpr int getLatencyInSamples() { return fftSize - hopSize; }
+
+    /**
+     * @brief To be called inside the owner's prepare method.
+     *
+     * @param numChannels the number of channels given to process()
+     */
+    void prepare (int numChannels);
+
+    /**
+     * @brief Clears every channel's history.
+     */
+    void reset();
+
+    /**
+     * @brief The pitch ratio, 2 for an octave up.
+     */
+    void setPitchRatio (float newRatio) { mRatio = newRatio; }
+
+    /**
+     * @brief Shifts numSamples samples of a channel, input and output may not overlap.
+     */
+    void process (int channel, const float* input, float* output, int numSamples);
+
+private:
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    struct Channel
+    {
+        std::vector<float> inputFifo, outputFifo, outputAccumulator;
+        std::vector<float> lastPhase, sumPhase;
+        int rover = 0;
+
+        // only used inside processFrame(). An FFT per channel too, some engines keep scratch space in it.
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> fftData, magnitudes, frequencies, shiftedMagnitudes, shiftedFrequencies;
+    };
+
+    /**
+     * @brief A periodic Hann window, computed once for every instance.
+     */
+    static const std::array<float, fftSize>& getWindowTable();
+
+    /**
+     * @brief Analysis, shift and resynthesis of the last fftSize
+     *        input samples, overlap-added to the output.
+     */
+    void processFrame (Channel& channel);
+
+    const std::array<float, fftSize>* mWindow = nullptr;
+    std::vector<Channel> mChannels;
+
+    float mRatio = 2.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchShifter)
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "Ducker.hpp"
+#include "juce_audio_processors/juce_audio_processors.h"
+#include <cmath>
+#include <memory>
+
+Ducker::Ducker (juce::AudioProcessorValueTreeState& valueTree) : apvts (valueTree),
+                                                                 mDepthParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Duck Depth"))),
+                                                                 mThresholdParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Duck Threshold"))),
+                                                                 mAttackParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Duck Attack"))),
+                                                                 mReleaseParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Duck Release"))),
+                                                                 mLookaheadParameter (dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("Duck Lookahead"))),
+                                                                 mSourceParameter (dynamic_cast<juce::AudioParameterChoice*> (apvts.getParameter ("Duck Source")))
+{
+}
+
+void Ducker::prepare (const juce::dsp::ProcessSpec& specs)
+{
+    mSampleRate = specs.sampleRate;
+
+    // Only ever grows, prepareToPlay() may be called often.
+    if (static_cast<int> (specs.maximumBlockSize) > mMaximumBlockSize)
+    {
+        mEnvelope.allocate (specs.maximumBlockSize, true);
+        mGains.allocate (specs.maximumBlockSize, true);
+        mMaximumBlockSize = static_cast<int> (specs.maximumBlockSize);
+    }
+
+    mLookaheadSamples = juce::jlimit (1, maxLookaheadSamples, juce::roundToInt (lookaheadSeconds * mSampleRate));
+    mLookaheadBuffer.setSize (static_cast<int> (specs.numChannels), mLookaheadSamples, false, false, true);
+    mScratch.setSize (1, mLookaheadSamples, false, false, true);
+    // Starts from the current values, the first block doesn't switch the lookahead.
+    setParameters (dumpParametersFromAPVTS());
+    mUseLookahead = mParameters.lookahead;
+
+    reset();
+}
+
+void Ducker::reset()
+{
+    mEnvelopeState = 0.0f;
+    mActive = false;
+    mLookaheadBuffer.clear();
+    mLookaheadPosition = 0;
+}
+
+Ducker::Parameters Ducker::dumpParametersFromAPVTS() const
+{
+    Parameters tempParams;
+
+    tempParams.depth     = mDepthParameter->get();
+    tempParams.threshold = mThresholdParameter->get();
+    tempParams.attack    = mAttackParameter->get();
+    tempParams.release   = mReleaseParameter->get();
+    tempParams.lookahead = mLookaheadParameter->get();
+    tempParams.source    = mSourceParameter->getIndex();
+
+    return tempParams;
+}
+
+void Ducker::setParameters (const Parameters& newParameters)
+{
+    mParameters = newParameters;
+    // The envelope coefficients divide by these.
+    mParameters.attack = juce::jmax (mAttackParameter->range.start, mParameters.attack);
+    mParameters.release = juce::jmax (mReleaseParameter->range.start, mParameters.release);
+    mParameters.source = juce::jlimit (0, mSourceParameter->choices.size() - 1, mParameters.source);
+}
+
+void Ducker::analyseKey (const juce::AudioBuffer<float>& key, int numSamples)
+{
+    jassert (numSamples <= mMaximumBlockSize);
+
+    // Toggling the lookahead starts it over, from silence.
+    const auto useLookahead = mParameters.lookahead;
+    if (useLookahead != mUseLookahead)
+    {
+        mUseLookahead = useLookahead;
+        mLookaheadBuffer.clear();
+        mLookaheadPosition = 0;
+    }
+
+    // How much of the wet signal goes away when fully ducked.
+    const auto depth = 1.0f - juce::Decibels::decibelsToGain (-mParameters.depth);
+    mActive = depth > 0.0f && key.getNumChannels() > 0;
+
+    if (!mActive)
+    {
+        mEnvelopeState = 0.0f;
+        return;
+    }
+
+    // Peak of the key's channels
+    juce::FloatVectorOperations::abs (mEnvelope, key.getReadPointer (0), numSamples);
+    for (int channel = 1; channel < key.getNumChannels(); ++channel)
+    {
+        juce::FloatVectorOperations::abs (mGains, key.getReadPointer (channel), numSamples);
+        juce::FloatVectorOperations::max (mEnvelope, mEnvelope, mGains, numSamples);
+    }
+
+    // Envelope follower, the one part that has to go sample by sample.
+    const auto attack = static_cast<float> (std::exp (-1.0 / (mParameters.attack * 0.001 * mSampleRate)));
+    const auto release = static_cast<float> (std::exp (-1.0 / (mParameters.release * 0.001 * mSampleRate)));
+
+    auto envelope = mEnvelopeState;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = mEnvelope[i];
+        const auto coefficient = input > envelope ? attack : release;
+        envelope = input + coefficient * (envelope - input);
+        mEnvelope[i] = envelope;
+    }
+    mEnvelopeState = envelope;
+
+    // Gain computer
+    const auto threshold = juce::Decibels::decibelsToGain (mParameters.threshold);
+    juce::FloatVectorOperations::add (mGains, mEnvelope, -threshold, numSamples);
+    juce::FloatVectorOperations::multiply (mGains, 1.0f / (3.0f * threshold), numSamples);
+    juce::FloatVectorOperations::clip (mGains, mGains, 0.0f, 1.0f, numSamples);
+    juce::FloatVectorOperations::multiply (mGains, -depth, numSamples);
+    juce::FloatVectorOperations::add (mGains, 1.0f, numSamples);
+}
+
+void Ducker::process (juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto&& block = context.getOutputBlock();
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), mLookaheadBuffer.getNumChannels());
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+
+    if (!mActive && !mUseLookahead)
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = block.getChannelPointer (static_cast<size_t> (channel));
+
+        if (mUseLookahead)
+            delayByLookahead (channel, data, numSamples);
+
+        if (mActive)
+            juce::FloatVectorOperations::multiply (data, mGains, numSamples);
+    }
+
+    if (mUseLookahead)
+        mLookaheadPosition = (mLookaheadPosition + numSamples) % mLookaheadSamples;
+}
+
+void Ducker::delayByLookahead (int channel, float* data, int numSamples)
+{
+    auto* line = mLookaheadBuffer.getWritePointer (channel);
+    auto* scratch = mScratch.getWritePointer (0);
+    auto position = mLookaheadPosition;
+
+    // swaps the block with what the line holds, one contiguous run at a time
+    for (int i = 0; i < numSamples;)
+    {
+        const auto length = juce::jmin (numSamples - i, mLookaheadSamples - position);
+
+        juce::FloatVectorOperations::copy (scratch, data + i, length);
+        juce::FloatVectorOperations::copy (data + i, line + position, length);
+        juce::FloatVectorOperations::copy (line + position, scratch, length);
+
+        i += length;
+        position += length;
+        if (position == mLookaheadSamples)
+            position = 0;
+    }
+}
+
+void Ducker::AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    // in dB, 0 (the default) means off
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Duck Depth", "Duck Depth", juce::NormalisableRange<float> (0.0f, 48.0f, 0.1f), 0.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Duck Threshold", "Duck Threshold", juce::NormalisableRange<float> (-60.0f, 0.0f, 0.1f), -30.0f));
+
+    // in ms
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Duck Attack", "Duck Attack", juce::NormalisableRange<float> (0.1f, 100.0f, 0.1f, 0.4f), 5.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Duck Release", "Duck Release", juce::NormalisableRange<float> (10.0f, 2000.0f, 1.0f, 0.4f), 250.0f));
+
+    // Adds Ducker::lookaheadSeconds of latency
+    layout.add (std::make_unique<juce::AudioParameterBool> ("Duck Lookahead", "Duck Lookahead", false));
+
+    juce::StringArray sources = { "Input", "Sidechain" };
+
+    layout.add (std::make_unique<juce::AudioParameterChoice> ("Duck Source", "Duck Source", sources, 0));
+}
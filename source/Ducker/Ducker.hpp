@@ -0,0 +1,135 @@
+#ifndef DUCKER_HPP
+#define DUCKER_HPP
+
+#include "juce_audio_processors/juce_audio_processors.h"
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+
+/**
+ * @brief Ducks the wet signal while the key (the dry input, or the
+ *        sidechain) is loud, so that the echoes don't mask it.
+ *
+ *        analyseKey() runs a peak envelope follower over the key, then
+ *        turns the envelope into gains with a handful of vectorised,
+ *        branch-free passes:
+ *            gain = 1 - depth * clip ((envelope - threshold) / (3 * threshold), 0, 1)
+ *        i.e. fully ducked 12dB above the threshold. process() applies
+ *        them to the wet signal, delayed by the lookahead when it's on.
+ */
+class Ducker
+{
+public:
+    /**
+     * @brief Holds the values the ducker works with during a block.
+     *        Mirrors Delay::Parameters.
+     */
+    struct Parameters
+    {
+        float depth     = 0.0f;   // Duck Depth, in dB
+        float threshold = -30.0f; // Duck Threshold, in dB
+        float attack    = 5.0f;   // Duck Attack, in ms
+        float release   = 250.0f; // Duck Release, in ms
+        bool  lookahead = false;  // Duck Lookahead
+        int   source    = 0;      // Duck Source, index in the choices
+    };
+
+    // The lookahead, and the most it can be at any sample rate.
+    static constexpr double lookaheadSeconds = 0.005;
+    static constexpr int maxLookaheadSamples = 1024;
+
+    Ducker(juce::AudioProcessorValueTreeState& valueTree);
+
+    /**
+     * @brief To be called inside the PluginProcessor::prepareToPlay method
+     *
+     * @param specs the juce::dsp::ProcessSpec related to this processor.
+     */
+    void prepare(const juce::dsp::ProcessSpec& specs);
+
+    /**
+     * @brief Clears the envelope and the lookahead.
+     */
+    void reset();
+
+    /**
+     * @brief Reads the current values of the ducker parameters in the APVTS.
+     */
+    Parameters dumpParametersFromAPVTS() const;
+
+    /**
+     * @brief Sets the values used by the next analyseKey(). To be called once
+     *        per block, either with dumpParametersFromAPVTS() or with values
+     *        computed elsewhere (e.g. by the PresetMorph).
+     */
+    void setParameters(const Parameters& newParameters);
+
+    /**
+     * @brief To be called first thing in PluginProcessor::processBlock, with the
+     *        key of this block, before anything processed it, and after setParameters().
+     *
+     * @param key the dry input or the sidechain
+     * @param numSamples the length of the block
+     */
+    void analyseKey(const juce::AudioBuffer<float>& key, int numSamples);
+
+    /**
+     * @brief Ducks the wet signal, with the gains of the last analyseKey().
+     */
+    void process(juce::dsp::ProcessContextReplacing<float>& context);
+
+    /**
+     * @brief How late the wet signal is, the dry signal has to be delayed as much.
+     *        Follows the lookahead set before the last analyseKey().
+     */
+    int getLatencyInSamples() const { return mUseLookahead ? mLookaheadSamples : 0; }
+
+    /**
+     * @brief The latency with the lookahead on, at the sample rate given to prepare().
+     */
+    int getMaxLatencyInSamples() const { return mLookaheadSamples; }
+
+    /**
+     * @brief Whether the key should come from the sidechain rather than the input.
+     */
+    bool wantsSidechain() const { return mParameters.source == 1; }
+
+    /**
+     * @brief Appends the list of parameters needed by this class to the main APVTS
+     *
+     * @param layout the main APVTS o the plugin
+     */
+    void AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+private:
+    /**
+     * @brief Delays a channel of numSamples by the lookahead, in place.
+     */
+    void delayByLookahead (int channel, float* data, int numSamples);
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    juce::AudioParameterFloat* mDepthParameter = nullptr;
+    juce::AudioParameterFloat* mThresholdParameter = nullptr;
+    juce::AudioParameterFloat* mAttackParameter = nullptr;
+    juce::AudioParameterFloat* mReleaseParameter = nullptr;
+    juce::AudioParameterBool* mLookaheadParameter = nullptr;
+    juce::AudioParameterChoice* mSourceParameter = nullptr;
+
+    Parameters mParameters;
+
+    juce::HeapBlock<float> mEnvelope, mGains; // one value per sample of the block
+    float mEnvelopeState = 0.0f;
+    bool mActive = false;
+
+    juce::AudioBuffer<float> mLookaheadBuffer, mScratch;
+    int mLookaheadPosition = 0;
+    int mLookaheadSamples = 0;
+    bool mUseLookahead = false;
+
+    int mMaximumBlockSize = 0;
+    double mSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Ducker)
+};
+
+#endif
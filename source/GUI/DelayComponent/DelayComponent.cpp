@@ -2,13 +2,15 @@
 #include "juce_graphics/juce_graphics.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 
-DelayComponent::DelayComponent (juce::AudioProcessorValueTreeState& audioTree) : mbackgroundColour (juce::Colour::fromRGB (50, 222, 138)),
-                                                                                 apvts (audioTree),
-                                                                                 mDelayTimeSliderAttachment (apvts, "Delay Time", mDelayTimeSlider.getslider()),
-                                                                                 mDelayFeedbackSliderAttachment (apvts, "Delay Feedback", mDelayFeedbackSlider.getslider()),
-                                                                                 mDelaySyncSliderAttachment (apvts, "Delay Sync", mDelaySyncSlider.getslider()),
-                                                                                 mDelaySyncToggleAttachment (apvts, "Delay Sync Toggle", mDelaySyncToggle.getToggle())
+DelayComponent::DelayComponent (juce::AudioProcessorValueTreeState& audioTree, RepaintCoordinator& repaintCoordinator) : mbackgroundColour (juce::Colour::fromRGB (50, 222, 138)),
+                                                                                                                         apvts (audioTree),
+                                                                                                                         mDelayTimeSliderAttachment (apvts, "Delay Time", mDelayTimeSlider.getslider(), repaintCoordinator),
+                                                                                                                         mDelayFeedbackSliderAttachment (apvts, "Delay Feedback", mDelayFeedbackSlider.getslider(), repaintCoordinator),
+                                                                                                                         mDelaySyncSliderAttachment (apvts, "Delay Sync", mDelaySyncSlider.getslider(), repaintCoordinator),
+                                                                                                                         mDelaySyncToggleAttachment (apvts, "Delay Sync Toggle", mDelaySyncToggle.getToggle(), repaintCoordinator)
 {
+    setOpaque (true);
+
     addAndMakeVisible (mDelayFeedbackSlider);
     addAndMakeVisible (mDelayTimeSlider);
     addAndMakeVisible (mDelaySyncSlider);
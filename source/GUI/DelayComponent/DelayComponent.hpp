@@ -5,12 +5,13 @@
 #include "juce_gui_basics/juce_gui_basics.h"
 
 #include "../Utils/Utils.hpp"
+#include "../Utils/RepaintCoordinator.hpp"
 
 class DelayComponent : public juce::Component
 {
 public:
 
-    DelayComponent(juce::AudioProcessorValueTreeState& audioTree);
+    DelayComponent(juce::AudioProcessorValueTreeState& audioTree, RepaintCoordinator& repaintCoordinator);
 
     ~DelayComponent() override;
 
@@ -29,11 +30,11 @@ private:
     
     ToggleAndLabel mDelaySyncToggle {"DLY::SYN"};
 
-    juce::AudioProcessorValueTreeState::SliderAttachment mDelayTimeSliderAttachment,
-                                                         mDelayFeedbackSliderAttachment,
-                                                         mDelaySyncSliderAttachment;
+    CoalescedSliderAttachment mDelayTimeSliderAttachment,
+                              mDelayFeedbackSliderAttachment,
+                              mDelaySyncSliderAttachment;
 
-    juce::AudioProcessorValueTreeState::ButtonAttachment mDelaySyncToggleAttachment;
+    CoalescedButtonAttachment mDelaySyncToggleAttachment;
         
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayComponent)
@@ -4,8 +4,8 @@
 #include "juce_data_structures/juce_data_structures.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 
-PresetManagerComponent::PresetManagerComponent(juce::AudioProcessorValueTreeState& valueTree) :
-    apvts(valueTree)
+PresetManagerComponent::PresetManagerComponent(juce::AudioProcessorValueTreeState& valueTree, PresetMorph& morph, PresetAuditionPlayer& player) :
+    apvts(valueTree), auditionPlayer(player), presetMorph(morph)
 {
     checkIfPresetsFolderPathExistsAndLoadPresets();
 
@@ -13,10 +13,15 @@ PresetManagerComponent::PresetManagerComponent(juce::AudioProcessorValueTreeStat
     mNextButton.setButtonText(" Next. ");
     mSaveButton.setButtonText(" Save. ");
     mDeleteButton.setButtonText(" Del. ");
+    mBundleButton.setButtonText(" Bnd. ");
+    mMorphAButton.setButtonText(" A ");
+    mMorphBButton.setButtonText(" B ");
+    mMorphAButton.setClickingTogglesState(true);
+    mMorphBButton.setClickingTogglesState(true);
 
-    mComboBox.setTextWhenNothingSelected("");
-    mComboBox.setSelectedId(mCurrentPresetIndex);
-    addAndMakeVisible(mComboBox);
+    mBrowseButton.setButtonText("");
+    mBrowseButton.setMouseCursor(juce::MouseCursor::PointingHandCursor);
+    addAndMakeVisible(mBrowseButton);
 
 
     for( auto button : getButtons() )
@@ -27,30 +32,63 @@ PresetManagerComponent::PresetManagerComponent(juce::AudioProcessorValueTreeStat
 
     mNextButton.onClick = [this]()
     {
-        if(mCurrentPresetIndex < mPresetsNameArray.size())
-        {
-            mCurrentPresetIndex++;
-            mComboBox.setSelectedId(mCurrentPresetIndex);
-            updateAPVTS(mPresetsArray[mCurrentPresetIndex]);
-        }
+        const auto currentRow = mPresetIndex.indexOfFile(mCurrentPresetFile);
+        if(currentRow + 1 < mPresetIndex.size())
+            loadPreset(currentRow + 1);
     };
     
     mPreviousButton.onClick = [this]()
     {
-        if(mCurrentPresetIndex > 1)
+        const auto currentRow = mPresetIndex.indexOfFile(mCurrentPresetFile);
+        if(currentRow > 0)
+            loadPreset(currentRow - 1);
+    };
+
+    mBrowseButton.onClick = [this]()
+    {
+        showPresetBrowser();
+    };
+
+    mBundleButton.onClick = [this]()
+    {
+        showBundleMenu();
+    };
+
+    mDeleteButton.onClick = [this]()
+    {
+        const auto row = mPresetIndex.indexOfFile(mCurrentPresetFile);
+        if(row < 0)
+            return;
+
+        const auto options = juce::MessageBoxOptions()
+                                 .withIconType(juce::MessageBoxIconType::WarningIcon)
+                                 .withTitle("Delete Preset")
+                                 .withMessage("Move \"" + mPresetIndex.getEntry(row).name + "\" to the trash?")
+                                 .withButton("Delete")
+                                 .withButton("Cancel")
+                                 .withAssociatedComponent(this);
+
+        juce::AlertWindow::showAsync(options, [safeThis = juce::Component::SafePointer<PresetManagerComponent>(this), file = mCurrentPresetFile](int result)
         {
-            mCurrentPresetIndex--;
-            mComboBox.setSelectedId(mCurrentPresetIndex);
-            updateAPVTS(mPresetsArray[mCurrentPresetIndex]);
-        }
+            if(safeThis != nullptr && result == 1)
+                safeThis->deletePreset(file);
+        });
+    };
+
+    mMorphAButton.onClick = [this]()
+    {
+        presetMorph.setSlot(PresetMorph::Slot::a, mMorphAButton.getToggleState() ? std::optional<Preset>(dumpAPVTSstate("A")) : std::nullopt);
     };
 
-    mComboBox.onChange = [this]()
+    mMorphBButton.onClick = [this]()
     {
-        mCurrentPresetIndex = mComboBox.getSelectedId();
-        updateAPVTS(mPresetsArray[mCurrentPresetIndex - 1]);
+        presetMorph.setSlot(PresetMorph::Slot::b, mMorphBButton.getToggleState() ? std::optional<Preset>(dumpAPVTSstate("B")) : std::nullopt);
     };
 
+    // The slots outlive the editor.
+    presetMorph.addChangeListener(this);
+    changeListenerCallback(&presetMorph);
+
     mSaveButton.onClick = [this]()
     {
         
@@ -69,6 +107,16 @@ PresetManagerComponent::PresetManagerComponent(juce::AudioProcessorValueTreeStat
     };
 }
 
+PresetManagerComponent::~PresetManagerComponent()
+{
+    // The browser refers to our index, it can't outlive us.
+    if (auto* callOut = mBrowserCallOut.getComponent())
+        delete callOut;
+
+    presetMorph.removeChangeListener(this);
+    auditionPlayer.stop();
+}
+
 void PresetManagerComponent::paint (juce::Graphics& g) 
 {
 }
@@ -98,128 +146,197 @@ void PresetManagerComponent::resized()
         Track (Fr (1)),
         Track (Fr (6)),
         Track (Fr (1)),
+        Track (Fr (1)),
+        Track (Fr (1)),
+        Track (Fr (1)),
         Track (Fr (1))
     };
 
-    for (int i = 0; i < 5; ++i)
+    for (int i = 0; i < 8; ++i)
         grid.items.set (i, juce::GridItem (nullptr));
 
     grid.items.set (0, mPreviousButton);
     grid.items.set (1, mNextButton);
-    grid.items.set (2, mComboBox);
+    grid.items.set (2, mBrowseButton);
     grid.items.set (3, mSaveButton);
     grid.items.set (4, mDeleteButton);
+    grid.items.set (5, mBundleButton);
+    grid.items.set (6, mMorphAButton);
+    grid.items.set (7, mMorphBButton);
 
 
     grid.performLayout (area);
+
+    if (mBundleProgressBar != nullptr)
+        mBundleProgressBar->setBounds (mBrowseButton.getBounds());
 }
 
-Preset PresetManagerComponent::loadPresetFromXML(juce::File xmlFile)
+void PresetManagerComponent::loadPreset(int row)
 {
-    if(xmlFile.existsAsFile())
-    {
-        Preset preset;
-        // parsing the xml file 
-        auto element = juce::XmlDocument::parse(xmlFile); // same as creating an object and calling getDocumentElement()
-        if(element->hasTagName("PRESET"))
+    if(!juce::isPositiveAndBelow(row, mPresetIndex.size()))
+        return;
+
+    mCurrentPresetFile = mPresetIndex.getFile(row);
+    mBrowseButton.setButtonText(mPresetIndex.getEntry(row).name);
+    updateAPVTS(mPresetIndex.loadPreset(row));
+}
+
+void PresetManagerComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    juce::ignoreUnused(source);
+
+    mMorphAButton.setToggleState(presetMorph.hasSlot(PresetMorph::Slot::a), juce::dontSendNotification);
+    mMorphBButton.setToggleState(presetMorph.hasSlot(PresetMorph::Slot::b), juce::dontSendNotification);
+}
+
+void PresetManagerComponent::showBundleMenu()
+{
+    if (mBundleJob != nullptr)
+        return;
+
+    juce::PopupMenu menu;
+    menu.addItem(1, "Import bundle...");
+    menu.addItem(2, "Export all presets...", mPresetIndex.size() > 0);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(mBundleButton),
+        [safeThis = juce::Component::SafePointer<PresetManagerComponent>(this)](int result)
         {
-            /*
-            * There, the goal is to fetch every data from every node.
-            * Our nodes are:
-            *  - INFORMATION
-            *  - PARAMETERS
-            *      - DELAY 
-            *      - REVERB 
-            *      - PLUGIN 
-            */
-            for(auto* e : element->getChildIterator())
+            if (safeThis == nullptr || result == 0)
+                return;
+
+            const bool isImport = result == 1;
+            const auto wildcard = juce::String("*") + PresetBundle::fileExtension;
+
+            safeThis->mBundleChooser = std::make_unique<juce::FileChooser>(isImport ? "Import presets" : "Export presets",
+                                                                           juce::File::getSpecialLocation(juce::File::userDocumentsDirectory),
+                                                                           wildcard);
+
+            const auto flags = isImport ? juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+                                        : juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting;
+
+            safeThis->mBundleChooser->launchAsync(flags, [safeThis, isImport](const juce::FileChooser& chooser)
             {
-                if (e->hasTagName("INFORMATION"))
-                {
-                    preset.presetName = e->getStringAttribute("Name");
-                    preset.authorName = e->getStringAttribute("Author");
-                    preset.category   = e->getStringAttribute("Category");
-                }
-                else if (e->hasTagName("PARAMETERS")) 
-                {
-                    for(auto* child : e->getChildIterator())
-                    {
-                        if(child->hasTagName("DELAY"))
-                        {
-                            preset.delayTime            = child->getIntAttribute("Time");
-                            preset.delayFeedback        = (float)child->getDoubleAttribute("Feedback");
-                            preset.delaySyncToggleState = child->getBoolAttribute("SyncToggle");
-                            preset.delaySyncDivider     = child->getIntAttribute("SyncDivider");
-                        }
-                        else if (child->hasTagName("REVERB")) 
-                        {
-                            preset.reverbDamping        = (float)child->getDoubleAttribute("Damping");
-                            preset.reverbFreezeState    = child->getBoolAttribute("Freeze");
-                            preset.reverbRoomSize       = (float)child->getDoubleAttribute("RoomSize");
-                            preset.reverbWet            = (float)child->getDoubleAttribute("Wet");
-                            preset.reverbDry            = (float)child->getDoubleAttribute("Dry");
-                            preset.reverbWidth          = (float)child->getDoubleAttribute("Width");
-                        }
-                        else if (child->hasTagName("PLUGIN"))
-                        {
-                            preset.pluginDryWet         = (float)child->getDoubleAttribute("DryWet");
-                            preset.pluginLevel          = (float)child->getDoubleAttribute("Level");
-                            preset.pluginGain           = (float)child->getDoubleAttribute("Gain");
-                        }
-                    }
-                }
-            }
-        }
-        return preset;
-    }
-    return {};
+                const auto file = chooser.getResult();
+                if (safeThis == nullptr || file == juce::File())
+                    return;
+
+                safeThis->startBundleJob(isImport ? PresetBundleJob::Direction::importBundle : PresetBundleJob::Direction::exportBundle,
+                                         isImport ? file : file.withFileExtension(PresetBundle::fileExtension));
+            });
+        });
+}
+
+void PresetManagerComponent::startBundleJob(PresetBundleJob::Direction direction, const juce::File& bundleFile)
+{
+    if (mBundleJob != nullptr)
+        return;
+
+    juce::Array<juce::File> presetFiles;
+    if (direction == PresetBundleJob::Direction::exportBundle)
+        for (int row = 0; row < mPresetIndex.size(); ++row)
+            presetFiles.add(mPresetIndex.getFile(row));
+
+    mBundleJob = std::make_unique<PresetBundleJob>(direction, bundleFile, Utils::PLUGIN_PRESET_PATH, presetFiles);
+
+    mBundleProgressBar = std::make_unique<juce::ProgressBar>(mBundleJob->getProgress());
+    mBundleProgressBar->setBounds(mBrowseButton.getBounds());
+    addAndMakeVisible(*mBundleProgressBar);
+
+    mBundleJob->onFinished = [safeThis = juce::Component::SafePointer<PresetManagerComponent>(this)](const juce::Array<juce::File>& importedFiles, bool succeeded)
+    {
+        if (safeThis == nullptr)
+            return;
+
+        // Imported presets are added to the index, they're read lazily like the others.
+        safeThis->mPresetIndex.addOrUpdate(importedFiles, [safeThis]()
+        {
+            if (safeThis != nullptr)
+                safeThis->updateBrowser();
+        });
+
+        safeThis->mBundleProgressBar.reset();
+        safeThis->mBundleJob.reset();
+
+        if (!succeeded)
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Presets bundle", "The bundle could not be processed.");
+    };
+
+    mBundleJob->startThread();
+}
+
+void PresetManagerComponent::auditionPreset(int row)
+{
+    if(!juce::isPositiveAndBelow(row, mPresetIndex.size()))
+        return;
+
+    if(auto clip = mAuditionCache.getClip(mPresetIndex.getEntry(row).contentHash))
+        auditionPlayer.play(clip->decode());
+}
+
+void PresetManagerComponent::showPresetBrowser()
+{
+    mAuditionCache.setSampleRate(apvts.processor.getSampleRate());
+
+    auto browser = std::make_unique<PresetListBox>(mPresetIndex, mAuditionCache);
+    browser->setSize(660, 12 * PresetListBox::rowHeight);
+    browser->selectRow(mPresetIndex.indexOfFile(mCurrentPresetFile));
+    browser->onPresetChosen = [this](int row)
+    {
+        loadPreset(row);
+
+        if (auto* callOut = mBrowserCallOut.getComponent())
+            callOut->dismiss();
+    };
+    browser->onAuditionRequested = [this](int row)
+    {
+        auditionPreset(row);
+    };
+
+    mBrowser = browser.get();
+    mBrowserCallOut = &juce::CallOutBox::launchAsynchronously(std::move(browser), mBrowseButton.getScreenBounds(), nullptr);
 }
 
 void PresetManagerComponent::savePresetToXML(juce::StringRef presetName)
 {
     auto preset = dumpAPVTSstate(presetName);
 
-    // Preset preset;
+    auto presetFile = Utils::PLUGIN_PRESET_PATH.getChildFile(preset.presetName.removeCharacters(" ") + ".xml");
 
-    juce::XmlElement motherNode ("PRESET");
-    juce::XmlElement* infoChild = new juce::XmlElement ("INFORMATION");
-    
-    infoChild->setAttribute("Name",     preset.presetName);
-    infoChild->setAttribute("Author",   preset.authorName);
-    infoChild->setAttribute("Category", preset.category);
-   
-    motherNode.addChildElement (infoChild);
-
-    juce::XmlElement* parameterChild   = new juce::XmlElement ("PARAMETERS");
-    juce::XmlElement* delayGrandChild  = new juce::XmlElement ("DELAY");
-    juce::XmlElement* reverbGrandChild = new juce::XmlElement ("REVERB");
-    juce::XmlElement* pluginGrandChild = new juce::XmlElement ("PLUGIN");
-
-    delayGrandChild->setAttribute("Time",        preset.delayTime);
-    delayGrandChild->setAttribute("Feedback",    preset.delayFeedback);
-    delayGrandChild->setAttribute("SyncToggle",  preset.delaySyncToggleState ? "true" : "false");
-    delayGrandChild->setAttribute("SyncDivider", preset.delaySyncDivider);
-
-    reverbGrandChild->setAttribute("Damping",    preset.reverbDamping);
-    reverbGrandChild->setAttribute("Freeze",     preset.reverbFreezeState ? "true" : "false");
-    reverbGrandChild->setAttribute("RoomSize",   preset.reverbRoomSize);
-    reverbGrandChild->setAttribute("Wet",        preset.reverbWet);
-    reverbGrandChild->setAttribute("Dry",        preset.reverbDry);
-    reverbGrandChild->setAttribute("Width",      preset.reverbWidth);
-
-    pluginGrandChild->setAttribute("DryWet",     preset.pluginDryWet);
-    pluginGrandChild->setAttribute("Level",      preset.pluginLevel);
-    pluginGrandChild->setAttribute("Gain",       preset.pluginGain);
-
-    parameterChild->addChildElement(delayGrandChild);
-    parameterChild->addChildElement(reverbGrandChild);
-    parameterChild->addChildElement(pluginGrandChild);
-
-    motherNode.addChildElement(parameterChild);
-
-    auto xmlString = motherNode.toString();
-
-    motherNode.writeTo(Utils::PLUGIN_PRESET_PATH.getChildFile(preset.presetName.removeCharacters(" ") + ".xml"));
+    if(preset.toXml()->writeTo(presetFile))
+    {
+        mPresetIndex.addOrUpdate(juce::Array<juce::File> { presetFile }, [safeThis = juce::Component::SafePointer<PresetManagerComponent>(this)]()
+        {
+            if (safeThis != nullptr)
+                safeThis->updateBrowser();
+        });
+        mCurrentPresetFile = presetFile;
+        mBrowseButton.setButtonText(preset.presetName);
+    }
+}
+
+void PresetManagerComponent::deletePreset(const juce::File& presetFile)
+{
+    if(!presetFile.moveToTrash() && !presetFile.deleteFile())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Delete Preset", "The preset could not be deleted.");
+        return;
+    }
+
+    mPresetIndex.remove(presetFile);
+
+    if(presetFile == mCurrentPresetFile)
+    {
+        mCurrentPresetFile = juce::File();
+        mBrowseButton.setButtonText("");
+    }
+
+    updateBrowser();
+}
+
+void PresetManagerComponent::updateBrowser()
+{
+    if (auto* browser = mBrowser.getComponent())
+        browser->updateContent();
 }
 
 std::vector<juce::TextButton*> PresetManagerComponent::getButtons()
@@ -229,70 +346,29 @@ std::vector<juce::TextButton*> PresetManagerComponent::getButtons()
         &mPreviousButton,
         &mNextButton,
         &mDeleteButton,
-        &mSaveButton
+        &mSaveButton,
+        &mBundleButton,
+        &mMorphAButton,
+        &mMorphBButton
     };
 }
 
 void PresetManagerComponent::checkIfPresetsFolderPathExistsAndLoadPresets()
 {
-    // if our plugin's folder doesn't exist on the system, 
-    if(!Utils::PLUGIN_PRESET_PATH.exists()) // Presets
-    {
-        DBG("Presets folder doesn't exists");
-        // We create every subdirectory if they don't exist
-        if(!Utils::PLUGIN_PRESET_PATH.getParentDirectory().exists()) // JucePlugin_Name
-        {
-            DBG(JucePlugin_Name " folder doesn't exists");
-
-            if(!Utils::PLUGIN_PRESET_PATH.getParentDirectory().getParentDirectory().exists()) // JucePlugin_Manufacturer
-            {
-                DBG(JucePlugin_Manufacturer " folder doesn't exists");
-                Utils::PLUGIN_PRESET_PATH.getParentDirectory().getParentDirectory().createDirectory(); 
-            }
-            Utils::PLUGIN_PRESET_PATH.getParentDirectory().createDirectory();
-        } 
-        Utils::PLUGIN_PRESET_PATH.createDirectory();
-    }
-    else // Our local presets directory exists  
+    // Creating the folder (and its parents) and listing it is done off
+    // the message thread, so that opening the editor doesn't wait on disk.
+    mPresetIndex.rescanAsync([safeThis = juce::Component::SafePointer<PresetManagerComponent>(this)]()
     {
-        mFileArray = Utils::PLUGIN_PRESET_PATH.findChildFiles(juce::File::TypesOfFileToFind::findFiles, false, "*.xml");
-
-        // Fill mPresetsArray
-        for (int i = 0; i < mFileArray.size(); ++i) 
-        {
-            mPresetsArray.add(loadPresetFromXML(mFileArray[i]));
-            mPresetsNameArray.add(mPresetsArray[i].presetName);
-        }
-        mComboBox.addItemList(mPresetsNameArray, 1);
-    }
+        // The index is shared, it may outlive us.
+        if (safeThis != nullptr)
+            safeThis->updateBrowser();
+    });
 }
 
 void PresetManagerComponent::updateAPVTS(Preset preset)
 {
-    // Not the perfect way of doing it...
-    juce::ValueTree newState
-    { "Parameters", {},
-        {
-            { "PARAM", {{ "id", "Delay Feedback"    }, { "value", preset.delayFeedback }}},
-            { "PARAM", {{ "id", "Delay Sync"        }, { "value", preset.delaySyncDivider }}},
-            { "PARAM", {{ "id", "Delay Sync Toggle" }, { "value", preset.delaySyncToggleState }}},
-            { "PARAM", {{ "id", "Delay Time"        }, { "value", preset.delayTime }}},
-            { "PARAM", {{ "id", "Output Level"      }, { "value", preset.pluginLevel }}},
-            { "PARAM", {{ "id", "Plugin Dry Wet"    }, { "value", preset.pluginDryWet }}},
-            { "PARAM", {{ "id", "Output Gain"       }, { "value", preset.pluginGain }}},
-            { "PARAM", {{ "id", "Reverb Damping"    }, { "value", preset.reverbDamping }}},
-            { "PARAM", {{ "id", "Reverb Dry"        }, { "value", preset.reverbDry }}},
-            { "PARAM", {{ "id", "Reverb Freeze"     }, { "value", preset.reverbFreezeState }}},
-            { "PARAM", {{ "id", "Reverb Room Size"  }, { "value", preset.reverbRoomSize }}},
-            { "PARAM", {{ "id", "Reverb Wet"        }, { "value", preset.reverbWet }}},
-            { "PARAM", {{ "id", "Reverb Width"      }, { "value", preset.reverbWidth }}},
-        }
-    };
-
-    if (newState.isValid())
-    {
-        apvts.replaceState(newState);
-    }
+    // Only what the preset stores changes, the rest of the state stays as it is.
+    preset.applyTo(apvts);
 }
 
 Preset PresetManagerComponent::dumpAPVTSstate(juce::StringRef presetName) 
@@ -303,21 +379,50 @@ Preset PresetManagerComponent::dumpAPVTSstate(juce::StringRef presetName)
     preset.authorName = "User";
     preset.category   = "USER";
 
-    preset.delayFeedback        = apvts.getParameter("Delay Feedback")->getValue();
-    preset.delayTime            = apvts.getParameterAsValue("Delay Time").getValue();
-    preset.delaySyncToggleState = static_cast<bool>(apvts.getParameter("Delay Sync Toggle")->getValue());
-    preset.delaySyncDivider     = apvts.getParameterAsValue("Delay Sync").getValue();
+    // Plain values, the same ones as the files in Resources/ and updateAPVTS() use.
+    auto value = [this](juce::StringRef parameterID) { return apvts.getRawParameterValue(parameterID)->load(); };
+
+    preset.delayFeedback        = value("Delay Feedback");
+    preset.delayTime            = juce::roundToInt(value("Delay Time"));
+    preset.delaySyncToggleState = value("Delay Sync Toggle") >= 0.5f;
+    preset.delaySyncDivider     = juce::roundToInt(value("Delay Sync"));
 
-    preset.pluginLevel          = apvts.getParameter("Output Level")->getValue();
-    preset.pluginGain           = apvts.getParameter("Output Gain")->getValue();
-    preset.pluginDryWet         = apvts.getParameter("Plugin Dry Wet")->getValue();
+    preset.pluginLevel          = value("Output Level");
+    preset.pluginGain           = value("Output Gain");
+    preset.pluginDryWet         = value("Plugin Dry Wet");
     
-    preset.reverbDamping        = apvts.getParameter("Reverb Damping")->getValue();
-    preset.reverbDry            = apvts.getParameter("Reverb Dry")->getValue();
-    preset.reverbFreezeState    = static_cast<bool>(apvts.getParameter("Reverb Freeze")->getValue());
-    preset.reverbRoomSize       = apvts.getParameter("Reverb Room Size")->getValue();
-    preset.reverbWet            = apvts.getParameter("Reverb Wet")->getValue();
-    preset.reverbWidth          = apvts.getParameter("Reverb Width")->getValue();
+    preset.reverbDamping        = value("Reverb Damping");
+    preset.reverbDry            = value("Reverb Dry");
+    preset.reverbFreezeState    = value("Reverb Freeze") >= 0.5f;
+    preset.reverbRoomSize       = value("Reverb Room Size");
+    preset.reverbWet            = value("Reverb Wet");
+    preset.reverbWidth          = value("Reverb Width");
+
+    preset.delayModRate         = value("Delay Mod Rate");
+    preset.delayModDepth        = value("Delay Mod Depth");
+    preset.delayModShape        = juce::roundToInt(value("Delay Mod Shape"));
+    preset.delayModStereo       = value("Delay Mod Stereo");
+
+    preset.delayMode                = juce::roundToInt(value("Delay Mode"));
+    preset.delayGrainSize           = value("Delay Grain Size");
+    preset.delayGrainDensity        = juce::roundToInt(value("Delay Grain Density"));
+    preset.delayGrainPitchJitter    = value("Delay Grain Pitch Jitter");
+    preset.delayGrainPositionJitter = value("Delay Grain Position Jitter");
+
+    preset.delayShimmer         = value("Delay Shimmer");
+    preset.delayShimmerPitch    = juce::roundToInt(value("Delay Shimmer Pitch"));
+
+    preset.duckDepth            = value("Duck Depth");
+    preset.duckThreshold        = value("Duck Threshold");
+    preset.duckAttack           = value("Duck Attack");
+    preset.duckRelease          = value("Duck Release");
+    preset.duckLookahead        = value("Duck Lookahead") >= 0.5f;
+    preset.duckSource           = juce::roundToInt(value("Duck Source"));
+
+    preset.stereoWidth          = value("Stereo Width");
+    preset.midGain              = value("Mid Gain");
+    preset.sideGain             = value("Side Gain");
+    preset.bassMonoFrequency    = value("Bass Mono Frequency");
 
     return preset;
 
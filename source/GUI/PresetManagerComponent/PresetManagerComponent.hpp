@@ -7,58 +7,30 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <memory>
 #include "../Utils/Utils.hpp"
+#include "../Utils/PresetListBox/PresetListBox.hpp"
+#include "../../Preset/Preset.hpp"
+#include "../../Preset/PresetIndex.hpp"
+#include "../../Preset/PresetMorph.hpp"
+#include "../../Preset/PresetBundle.hpp"
+#include "../../Preset/PresetAudition.hpp"
 
 /**
- * @brief a simple struct to contain every parameter and 
- *        values of a preset dumped from an XML file. 
+ * @brief What every PresetManagerComponent of the process shares through
+ *        a juce::SharedResourcePointer: the index of the preset folder
+ *        and the rendered auditions. Message thread only.
  */
-struct Preset 
+struct SharedPresetLibrary
 {
-    // PRESET INFO
-    juce::String presetName    = {};
-    juce::String authorName    = {};
-    juce::String category      = {};
-
-    // PARAMETERS VALUES
-    //    DELAY 
-    int   delayTime            = 0;
-    float delayFeedback        = 0.0f;
-    bool  delaySyncToggleState = false;
-    int   delaySyncDivider     = 1;
-
-    //    REVERB
-    float reverbDamping        = 0.0f;
-    bool  reverbFreezeState    = false;
-    float reverbRoomSize       = 0.0f;
-    float reverbWet            = 0.0f;
-    float reverbDry            = 0.0f;
-    float reverbWidth          = 0.0f;
-
-    //    PLUGIN
-    float pluginDryWet         = 0.0f;
-    float pluginLevel          = 0.0f;
-    float pluginGain           = 0.0f;
-
-    #if DEBUG
-    /* ========= MEMBERS ========== */
-    void print()
-    {
-        // DBG PURPOSES ONLY
-        DBG("presetName:");        DBG(presetName);
-        DBG("authorName:");        DBG(authorName);
-        DBG("category:");          DBG(category);
-        DBG("delayTime:");         DBG(delayTime);
-        DBG("reverbDamping:");     DBG(reverbDamping);
-        DBG("pluginDryWet:");      DBG(pluginDryWet);
-    }
-    #endif
+    PresetIndex index { Utils::PLUGIN_PRESET_PATH };
+    PresetAuditionCache auditions;
 };
 
-
-class PresetManagerComponent : public juce::Component
+class PresetManagerComponent : public juce::Component,
+                               private juce::ChangeListener
 {
 public:
-    PresetManagerComponent(juce::AudioProcessorValueTreeState& valueTree);
+    PresetManagerComponent(juce::AudioProcessorValueTreeState& valueTree, PresetMorph& morph, PresetAuditionPlayer& player);
+    ~PresetManagerComponent() override;
 
     void paint (juce::Graphics& g) override;
 
@@ -68,13 +40,34 @@ private:
     /* =================== MEMBERS ======================= */
 
     juce::TextButton mPreviousButton, mNextButton, mSaveButton, mDeleteButton;
-    juce::ComboBox mComboBox; // Right now, only a combo box. TODO: Replace with PrestListBoxComponent
-    juce::Array<juce::File> mFileArray = {};
-    juce::Array<Preset> mPresetsArray = {};
-    juce::StringArray mPresetsNameArray = {};
-    int mCurrentPresetIndex = 0;
+    juce::TextButton mBrowseButton; // Shows the current preset, opens the PresetListBox
+
+    // Shared with the other instances. Rows move when any of them sorts,
+    // so the current preset is remembered by file rather than by row.
+    juce::SharedResourcePointer<SharedPresetLibrary> mLibrary;
+    PresetIndex& mPresetIndex { mLibrary->index };
+    juce::File mCurrentPresetFile;
     juce::AudioProcessorValueTreeState& apvts;
 
+    juce::Component::SafePointer<juce::CallOutBox> mBrowserCallOut;
+    juce::Component::SafePointer<PresetListBox> mBrowser;
+
+    // Auditions shown and played by the browser
+    PresetAuditionCache& mAuditionCache { mLibrary->auditions };
+    PresetAuditionPlayer& auditionPlayer;
+
+    // Morph slots, kept by the PresetMorph. Toggling A or B on captures
+    // the current state, toggling it off clears the slot and stops the morph.
+    juce::TextButton mMorphAButton, mMorphBButton;
+    PresetMorph& presetMorph;
+
+    // Bundle import/export. The progress bar covers the browse
+    // button while a job is running.
+    juce::TextButton mBundleButton;
+    std::unique_ptr<juce::FileChooser> mBundleChooser;
+    std::unique_ptr<PresetBundleJob> mBundleJob;
+    std::unique_ptr<juce::ProgressBar> mBundleProgressBar;
+
     std::unique_ptr<juce::AlertWindow> asyncAlertWindow;
 
     /* =================== METHODS ======================= */
@@ -90,18 +83,47 @@ private:
     /**
      * @brief checks if the complete preset path exists 
      *        and if it doesn't, creates it and loads 
-     *        its content.
+     *        its content. Asynchronous, the index is
+     *        empty until the scan is done.
      */
     void checkIfPresetsFolderPathExistsAndLoadPresets();
     
     /**
-     * @brief Dump the content of the xml file 'xmlFile'
-     *        and returns it in a Preset structure form. 
-     * 
-     * @param xmlFile the juce::File corresponding to the preset stored as xml.
-     * @return Preset 
+     * @brief Loads the preset displayed at row in the index
+     *        and applies it to the APVTS.
+     *
+     * @param row the row of the preset in mPresetIndex.
+     */
+    void loadPreset(int row);
+
+    /**
+     * @brief Shows which morph slots are set, e.g. after the
+     *        plugin state was restored. From the PresetMorph.
+     */
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+    /**
+     * @brief Shows the Import/Export menu of the bundle button.
      */
-    Preset loadPresetFromXML(juce::File xmlFile);
+    void showBundleMenu();
+
+    /**
+     * @brief Starts importing or exporting a bundle on a background thread.
+     *        Does nothing if a job is already running.
+     */
+    void startBundleJob(PresetBundleJob::Direction direction, const juce::File& bundleFile);
+
+    /**
+     * @brief Plays the audition of the preset at row if it's ready.
+     *        The live instance keeps its own settings.
+     */
+    void auditionPreset(int row);
+
+    /**
+     * @brief Opens the preset browser in a call-out box
+     *        pointing at the browse button.
+     */
+    void showPresetBrowser();
     
     /**
      * @brief dumps the state of the apvts and saves it as an XML file.
@@ -109,9 +131,20 @@ private:
     void savePresetToXML(juce::StringRef presetName);
 
     /**
-     * @brief Updates the state of the current apvts (set previously by reference)
-     *        using the preset param values. This internally uses a juce::ValueTree
-     *        and the AudioProcessorValueTreeState::replaceState() method. 
+     * @brief Moves presetFile to the trash (or deletes it if there's
+     *        none) and takes it out of the index.
+     */
+    void deletePreset(const juce::File& presetFile);
+
+    /**
+     * @brief Shows the index' new content in the browser, if it's open.
+     */
+    void updateBrowser();
+
+    /**
+     * @brief Updates the parameters of the current apvts (set previously by reference)
+     *        stored in the preset, through Preset::applyTo(). The parameters a preset
+     *        doesn't store keep their values.
      * @param preset The set of values that represent a preset.
      */
     void updateAPVTS(Preset preset);
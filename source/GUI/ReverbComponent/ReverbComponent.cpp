@@ -1,14 +1,16 @@
 #include "ReverbComponent.hpp"
 
-ReverbComponent::ReverbComponent (juce::AudioProcessorValueTreeState& audioTree) : mbackgroundColour (juce::Colour::fromRGB (225, 90, 151)),
-                                                                                   apvts (audioTree),
-                                                                                   mReverbDampingSliderAttachement (apvts, "Reverb Damping", mReverbDampingSlider.getslider()),
-                                                                                   mReverbRoomSizeSliderAttachement (apvts, "Reverb Room Size", mReverbRoomSizeSlider.getslider()),
-                                                                                   mReverbWetSliderAttachement (apvts, "Reverb Wet", mReverbWetSlider.getslider()),
-                                                                                   mReverbDrySliderAttachement (apvts, "Reverb Dry", mReverbDrySlider.getslider()),
-                                                                                   mReverbWidthSliderAttachement (apvts, "Reverb Width", mReverbWidthSlider.getslider()),
-                                                                                   mReverbFreezeToggleAttachement (apvts, "Reverb Freeze", mReverbFreezeToggle.getToggle())
+ReverbComponent::ReverbComponent (juce::AudioProcessorValueTreeState& audioTree, RepaintCoordinator& repaintCoordinator) : mbackgroundColour (juce::Colour::fromRGB (225, 90, 151)),
+                                                                                                                           apvts (audioTree),
+                                                                                                                           mReverbDampingSliderAttachement (apvts, "Reverb Damping", mReverbDampingSlider.getslider(), repaintCoordinator),
+                                                                                                                           mReverbRoomSizeSliderAttachement (apvts, "Reverb Room Size", mReverbRoomSizeSlider.getslider(), repaintCoordinator),
+                                                                                                                           mReverbWetSliderAttachement (apvts, "Reverb Wet", mReverbWetSlider.getslider(), repaintCoordinator),
+                                                                                                                           mReverbDrySliderAttachement (apvts, "Reverb Dry", mReverbDrySlider.getslider(), repaintCoordinator),
+                                                                                                                           mReverbWidthSliderAttachement (apvts, "Reverb Width", mReverbWidthSlider.getslider(), repaintCoordinator),
+                                                                                                                           mReverbFreezeToggleAttachement (apvts, "Reverb Freeze", mReverbFreezeToggle.getToggle(), repaintCoordinator)
 {
+    setOpaque (true);
+
     addAndMakeVisible (mReverbFreezeToggle);
     addAndMakeVisible (mReverbDampingSlider);
     addAndMakeVisible (mReverbRoomSizeSlider);
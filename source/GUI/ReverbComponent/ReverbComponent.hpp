@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "../Utils/Utils.hpp"
+#include "../Utils/RepaintCoordinator.hpp"
 
 /**
  * @brief The juce::component related to the reverb
@@ -17,7 +18,7 @@
 class ReverbComponent : public juce::Component
 {
 public:
-    ReverbComponent (juce::AudioProcessorValueTreeState& audioTree);
+    ReverbComponent (juce::AudioProcessorValueTreeState& audioTree, RepaintCoordinator& repaintCoordinator);
 
     ~ReverbComponent() override;
 
@@ -39,15 +40,15 @@ private:
                    mReverbDrySlider { "REV::DRY" },
                    mReverbWidthSlider { "REV::WID" };
 
-    juce::AudioProcessorValueTreeState::SliderAttachment mReverbDampingSliderAttachement,
-                                                         mReverbRoomSizeSliderAttachement,
-                                                         mReverbWetSliderAttachement,
-                                                         mReverbDrySliderAttachement,
-                                                         mReverbWidthSliderAttachement;
+    CoalescedSliderAttachment mReverbDampingSliderAttachement,
+                              mReverbRoomSizeSliderAttachement,
+                              mReverbWetSliderAttachement,
+                              mReverbDrySliderAttachement,
+                              mReverbWidthSliderAttachement;
 
     // Reverb Freeze Toggle and everything related
     ToggleAndLabel mReverbFreezeToggle { "REV::FRZ" };
-    juce::AudioProcessorValueTreeState::ButtonAttachment
+    CoalescedButtonAttachment
         mReverbFreezeToggleAttachement;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReverbComponent)
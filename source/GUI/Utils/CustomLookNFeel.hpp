@@ -3,6 +3,9 @@
 #include "juce_core/juce_core.h"
 #include "juce_graphics/juce_graphics.h"
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <map>
+
+#include "Utils.hpp"
 
 class CustomLookNFeel : public juce::LookAndFeel_V4
 {
@@ -17,19 +20,11 @@ public:
         auto rw = radius * 2.0f;
         auto angle = rotaryStartAngle + sliderPosProportional * (rotaryEndAngle - rotaryStartAngle);
 
-        juce::DropShadow shadow (juce::Colour::fromRGBA(0, 0, 0, 64), 4, juce::Point(4, 4));
-
-        juce::Path ellipseAsPath;
-        ellipseAsPath.addEllipse (rx, ry, rw, rw);
-        shadow.drawForPath(g, ellipseAsPath);
-
-        // outline
-        g.setColour (juce::Colours::white);
-        g.drawEllipse (rx, ry, rw, rw, 5.0f);
-
-        // fill
-        g.setColour (juce::Colours::black);
-        g.fillEllipse (rx, ry, rw, rw);
+        // The body (shadow, outline and fill) never changes with the value,
+        // it's rendered once per size and scale and then only blitted.
+        const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const auto& body = getKnobBody (rw, scale);
+        g.drawImage (body, juce::Rectangle<float> (rx - knobMargin, ry - knobMargin, rw + 2.0f * knobMargin, rw + 2.0f * knobMargin));
 
         // Drawing the pointer
         juce::Path p;
@@ -144,6 +139,49 @@ public:
 
 
 private:
-    juce::FontOptions fontOptions {"JetBrainsMono NFM", "Bold", 18.0f};
+    // Room around the knob for its outline and drop shadow.
+    static constexpr float knobMargin = 12.0f;
+
+    /**
+     * @brief Returns the pre-rendered body of a knob of the given
+     *        diameter, rendering it first if needed.
+     */
+    const juce::Image& getKnobBody (float diameter, float scale)
+    {
+        const auto key = juce::String (juce::roundToInt (diameter * 4.0f)) + "@" + juce::String (juce::roundToInt (scale * 100.0f));
+
+        if (auto cached = knobBodies.find (key); cached != knobBodies.end())
+            return cached->second;
+
+        // Only a handful of sizes exist at once, this is just a safety net.
+        if (knobBodies.size() > 32)
+            knobBodies.clear();
+
+        const auto size = diameter + 2.0f * knobMargin;
+        juce::Image image (juce::Image::ARGB, juce::jmax (1, juce::roundToInt (size * scale)), juce::jmax (1, juce::roundToInt (size * scale)), true);
+        {
+            juce::Graphics g (image);
+            g.addTransform (juce::AffineTransform::scale (scale));
+
+            juce::DropShadow shadow (juce::Colour::fromRGBA(0, 0, 0, 64), 4, juce::Point(4, 4));
+
+            juce::Path ellipseAsPath;
+            ellipseAsPath.addEllipse (knobMargin, knobMargin, diameter, diameter);
+            shadow.drawForPath(g, ellipseAsPath);
+
+            // outline
+            g.setColour (juce::Colours::white);
+            g.drawEllipse (knobMargin, knobMargin, diameter, diameter, 5.0f);
+
+            // fill
+            g.setColour (juce::Colours::black);
+            g.fillEllipse (knobMargin, knobMargin, diameter, diameter);
+        }
+
+        return knobBodies.emplace (key, std::move (image)).first->second;
+    }
+
+    std::map<juce::String, juce::Image> knobBodies;
+    juce::FontOptions fontOptions = Utils::Fonts::get(18.0f);
 
 };
@@ -1,16 +1,108 @@
+#pragma once
+
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "PresetListBoxModel.hpp"
 
-class PresetListBox
+/**
+ * @brief The preset browser. A TableListBox with a fixed row
+ *        height, so only the visible rows ever get painted
+ *        whatever the size of the library.
+ */
+class PresetListBox : public juce::Component,
+                      private juce::ChangeListener
 {
 public:
-    PresetListBox()
+    static constexpr int rowHeight = 22;
+
+    PresetListBox (PresetIndex& index, PresetAuditionCache& cache) : model (index, cache), auditionCache (cache)
     {
-        mPresetList.setModel(dynamic_cast<juce::ListBoxModel*>(&model));
+        mPresetList.setModel (&model);
+        mPresetList.setRowHeight (rowHeight);
+        mPresetList.setColour (juce::ListBox::backgroundColourId, juce::Colour::fromRGB (36, 22, 35));
+        mPresetList.setColour (juce::ListBox::outlineColourId, juce::Colours::white);
+        mPresetList.setOutlineThickness (2);
+
+        auto& header = mPresetList.getHeader();
+        const auto flags = juce::TableHeaderComponent::visible | juce::TableHeaderComponent::resizable | juce::TableHeaderComponent::sortable;
+        header.addColumn ("Name",     PresetListBoxModel::nameColumn,     180, 60, -1, flags);
+        header.addColumn ("Author",   PresetListBoxModel::authorColumn,   120, 60, -1, flags);
+        header.addColumn ("Category", PresetListBoxModel::categoryColumn, 100, 60, -1, flags);
+        header.addColumn ("Modified", PresetListBoxModel::dateColumn,     130, 60, -1, flags);
+        header.addColumn ("Preview",  PresetListBoxModel::previewColumn,  100, 60, -1, juce::TableHeaderComponent::visible | juce::TableHeaderComponent::resizable);
+
+        model.onSortOrderChanged = [safeThis = juce::Component::SafePointer<PresetListBox> (this)]()
+        {
+            if (safeThis != nullptr)
+                safeThis->updateContent();
+        };
 
-        
+        model.onRowChosen = [this] (int row)
+        {
+            if (onPresetChosen != nullptr)
+                onPresetChosen (row);
+        };
+
+        model.onAuditionRequested = [this] (int row)
+        {
+            if (onAuditionRequested != nullptr)
+                onAuditionRequested (row);
+        };
+
+        auditionCache.addChangeListener (this);
+        addAndMakeVisible (mPresetList);
     }
+
+    ~PresetListBox() override
+    {
+        auditionCache.removeChangeListener (this);
+        mPresetList.setModel (nullptr);
+    }
+
+    void resized() override
+    {
+        mPresetList.setBounds (getLocalBounds());
+    }
+
+    /**
+     * @brief Selects and scrolls to row without notifying anyone.
+     */
+    void selectRow (int row)
+    {
+        mPresetList.selectRow (row, false, true);
+    }
+
+    /**
+     * @brief To be called when the index changed, e.g. after a rescan.
+     */
+    void updateContent()
+    {
+        mPresetList.updateContent();
+        mPresetList.repaint();
+    }
+
+    /**
+     * @brief Called with the row (in the index' sort order)
+     *        the user double-clicked or hit return on.
+     */
+    std::function<void (int)> onPresetChosen;
+
+    /**
+     * @brief Called with the row whose preview was clicked.
+     */
+    std::function<void (int)> onAuditionRequested;
+
 private:
+    /**
+     * @brief A new audition is ready, the visible previews may show it.
+     */
+    void changeListenerCallback (juce::ChangeBroadcaster*) override
+    {
+        mPresetList.repaint();
+    }
+
     PresetListBoxModel model;
-    juce::ListBox mPresetList;
-};
\ No newline at end of file
+    PresetAuditionCache& auditionCache;
+    juce::TableListBox mPresetList;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetListBox)
+};
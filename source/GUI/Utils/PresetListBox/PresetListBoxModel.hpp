@@ -2,40 +2,166 @@
 
 #include "juce_core/juce_core.h"
 #include <juce_gui_basics/juce_gui_basics.h>
-#include <memory>
+#include <functional>
 
+#include "../../../Preset/PresetIndex.hpp"
+#include "../../../Preset/PresetAudition.hpp"
+#include "../Utils.hpp"
+
+/**
+ * @brief The model behind the preset browser.
+ *        It doesn't hold any preset: every cell is pulled
+ *        on demand from the PresetIndex, and the TableListBox
+ *        only asks for the rows that are currently visible.
+ *        Auditions are only requested for those rows too.
+ */
 class PresetListBoxModel : public juce::TableListBoxModel
 {
 public:
-    PresetListBoxModel();
+    enum ColumnIds
+    {
+        nameColumn = 1,
+        authorColumn,
+        categoryColumn,
+        dateColumn,
+        previewColumn
+    };
+
+    PresetListBoxModel (PresetIndex& index, PresetAuditionCache& cache) : presetIndex (index), auditionCache (cache) {}
 
     /**
      * @brief an override from TableListBoxModel
      */
     int getNumRows() override
     {
+        return presetIndex.size();
+    }
+
+    /**
+     * @brief an override from TableListBoxModel
+     */
+    void paintRowBackground (juce::Graphics& g, int rowNumber, int width, int height, bool rowIsSelected) override
+    {
+        juce::ignoreUnused (width, height);
 
+        if (rowIsSelected)
+            g.fillAll (juce::Colour::fromRGB (225, 90, 151));
+        else
+            g.fillAll (rowNumber % 2 == 0 ? juce::Colour::fromRGB (36, 22, 35)
+                                          : juce::Colour::fromRGB (46, 32, 45));
     }
 
     /**
      * @brief an override from TableListBoxModel
      */
-    void paintRowBackground (juce::Graphics &g, int rowNumber, int width, int height, bool rowIsSelected) override
+    void paintCell (juce::Graphics& g, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override
     {
+        juce::ignoreUnused (rowIsSelected);
+
+        if (!juce::isPositiveAndBelow (rowNumber, presetIndex.size()))
+            return;
 
+        const auto& entry = presetIndex.getEntry (rowNumber);
+
+        if (columnId == previewColumn)
+        {
+            paintPreview (g, entry, width, height);
+            return;
+        }
+
+        juce::String text;
+
+        switch (columnId)
+        {
+            case nameColumn:     text = entry.name; break;
+            case authorColumn:   text = entry.author; break;
+            case categoryColumn: text = entry.category; break;
+            case dateColumn:     text = entry.modificationTime.formatted ("%Y-%m-%d %H:%M"); break;
+            default: break;
+        }
+
+        g.setFont (juce::Font (fontOptions));
+        g.setColour (juce::Colours::white);
+        g.drawText (text, 4, 0, width - 8, height, juce::Justification::centredLeft, true);
     }
 
     /**
      * @brief an override from TableListBoxModel
      */
-    void paintCell (juce::Graphics &g, int rowNumber, int columnId, int width, int height, bool rowIsSelected) override
+    void sortOrderChanged (int newSortColumnId, bool isForwards) override
     {
+        // The rows may only be in order later on, sort() calls back then.
+        switch (newSortColumnId)
+        {
+            case nameColumn:     presetIndex.sort (PresetIndex::SortKey::name, isForwards, onSortOrderChanged); break;
+            case authorColumn:   presetIndex.sort (PresetIndex::SortKey::author, isForwards, onSortOrderChanged); break;
+            case categoryColumn: presetIndex.sort (PresetIndex::SortKey::category, isForwards, onSortOrderChanged); break;
+            case dateColumn:     presetIndex.sort (PresetIndex::SortKey::modificationDate, isForwards, onSortOrderChanged); break;
+            default: return;
+        }
+    }
 
+    /**
+     * @brief an override from TableListBoxModel
+     */
+    void cellClicked (int rowNumber, int columnId, const juce::MouseEvent&) override
+    {
+        if (columnId == previewColumn && onAuditionRequested != nullptr)
+            onAuditionRequested (rowNumber);
     }
 
+    /**
+     * @brief an override from TableListBoxModel
+     */
+    void cellDoubleClicked (int rowNumber, int columnId, const juce::MouseEvent&) override
+    {
+        juce::ignoreUnused (columnId);
+
+        if (onRowChosen != nullptr)
+            onRowChosen (rowNumber);
+    }
+
+    /**
+     * @brief an override from TableListBoxModel
+     */
+    void returnKeyPressed (int lastRowSelected) override
+    {
+        if (onRowChosen != nullptr)
+            onRowChosen (lastRowSelected);
+    }
+
+    std::function<void()> onSortOrderChanged; // may be called after the browser is gone
+    std::function<void (int)> onRowChosen;
+    std::function<void (int)> onAuditionRequested;
+
 private:
-    std::unique_ptr<juce::XmlElement> mPreset;
-    juce::XmlElement* mInfoList = nullptr;
-    juce::XmlElement* mParameterList = nullptr;
+    /**
+     * @brief Draws the waveform of the row's audition,
+     *        or asks for it to be rendered.
+     */
+    void paintPreview (juce::Graphics& g, const PresetIndex::Entry& entry, int width, int height)
+    {
+        auto clip = auditionCache.getClip (entry.contentHash);
+        if (clip == nullptr)
+        {
+            auditionCache.requestClip (entry.contentHash, entry.file);
+            return;
+        }
+
+        const auto numPoints = PresetAuditionClip::numThumbnailPoints;
+        const auto pointWidth = static_cast<float> (width - 8) / static_cast<float> (numPoints);
+        const auto middle = static_cast<float> (height) * 0.5f;
+
+        g.setColour (juce::Colour::fromRGB (50, 222, 138));
+        for (int point = 0; point < numPoints; ++point)
+        {
+            const auto top = middle - juce::jlimit (0.0f, 1.0f, clip->thumbnail[static_cast<size_t> (2 * point + 1)]) * middle;
+            const auto bottom = middle - juce::jlimit (-1.0f, 0.0f, clip->thumbnail[static_cast<size_t> (2 * point)]) * middle;
+            g.fillRect (4.0f + static_cast<float> (point) * pointWidth, top, juce::jmax (1.0f, pointWidth - 1.0f), juce::jmax (1.0f, bottom - top));
+        }
+    }
 
-};
\ No newline at end of file
+    PresetIndex& presetIndex;
+    PresetAuditionCache& auditionCache;
+    juce::FontOptions fontOptions = Utils::Fonts::get (14.0f);
+};
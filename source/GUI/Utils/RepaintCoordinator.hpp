@@ -0,0 +1,221 @@
+#pragma once
+
+#include "juce_audio_processors/juce_audio_processors.h"
+#include "juce_core/juce_core.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief Something the RepaintCoordinator applies once per vblank.
+ */
+class CoalescedAttachment
+{
+public:
+    virtual ~CoalescedAttachment() = default;
+
+    /**
+     * @brief Pushes the last value received from the parameter to the widget.
+     */
+    virtual void applyPendingValue() = 0;
+
+    bool isPending = false;
+};
+
+/**
+ * @brief Coalesces the parameter changes of the whole editor.
+ *
+ *        Host automation notifies the attachments as often as it
+ *        likes; they only remember the last value and register here.
+ *        Once per vblank the widgets get their new value, each of
+ *        them repainting its own bounds only, whatever the number
+ *        of notifications in between. Message thread only.
+ *
+ *        The panels the widgets sit on (DelayComponent, ReverbComponent)
+ *        fill every pixel in paint() and are set opaque, so a knob's
+ *        repaint stops at its panel instead of reaching the editor.
+ */
+class RepaintCoordinator
+{
+public:
+    explicit RepaintCoordinator (juce::Component& editor) : vBlankAttachment (&editor, [this]() { flush(); })
+    {
+        mPending.reserve (32);
+    }
+
+    void markPending (CoalescedAttachment& attachment)
+    {
+        if (attachment.isPending)
+            return;
+
+        attachment.isPending = true;
+        mPending.push_back (&attachment);
+    }
+
+    void remove (CoalescedAttachment& attachment)
+    {
+        mPending.erase (std::remove (mPending.begin(), mPending.end(), &attachment), mPending.end());
+        attachment.isPending = false;
+    }
+
+    /**
+     * @brief Applies every pending value. Called on vblank.
+     */
+    void flush()
+    {
+        for (auto* attachment : mPending)
+        {
+            attachment->isPending = false;
+            attachment->applyPendingValue();
+        }
+
+        mPending.clear();
+    }
+
+private:
+    std::vector<CoalescedAttachment*> mPending;
+    juce::VBlankAttachment vBlankAttachment;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RepaintCoordinator)
+};
+
+/**
+ * @brief Same as juce::AudioProcessorValueTreeState::SliderAttachment,
+ *        except that the slider only follows the parameter once per
+ *        vblank, through the RepaintCoordinator.
+ */
+class CoalescedSliderAttachment : public CoalescedAttachment,
+                                  private juce::Slider::Listener
+{
+public:
+    CoalescedSliderAttachment (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Slider& s, RepaintCoordinator& repaintCoordinator)
+        : slider (s),
+          coordinator (repaintCoordinator),
+          parameter (*apvts.getParameter (parameterID)),
+          attachment (parameter, [this] (float newValue) { mPendingValue = newValue; coordinator.markPending (*this); }, apvts.undoManager)
+    {
+        slider.valueFromTextFunction = [this] (const juce::String& text) { return static_cast<double> (parameter.convertFrom0to1 (parameter.getValueForText (text))); };
+        slider.textFromValueFunction = [this] (double value) { return parameter.getText (parameter.convertTo0to1 (static_cast<float> (value)), 0); };
+        slider.setDoubleClickReturnValue (true, parameter.convertFrom0to1 (parameter.getDefaultValue()));
+
+        // The slider keeps the parameter's skew and snapping.
+        auto range = parameter.getNormalisableRange();
+
+        auto convertFrom0To1 = [range] (double start, double end, double normalised) mutable
+        {
+            range.start = static_cast<float> (start);
+            range.end = static_cast<float> (end);
+            return static_cast<double> (range.convertFrom0to1 (static_cast<float> (normalised)));
+        };
+
+        auto convertTo0To1 = [range] (double start, double end, double mapped) mutable
+        {
+            range.start = static_cast<float> (start);
+            range.end = static_cast<float> (end);
+            return static_cast<double> (range.convertTo0to1 (static_cast<float> (mapped)));
+        };
+
+        auto snapToLegalValue = [range] (double start, double end, double mapped) mutable
+        {
+            range.start = static_cast<float> (start);
+            range.end = static_cast<float> (end);
+            return static_cast<double> (range.snapToLegalValue (static_cast<float> (mapped)));
+        };
+
+        juce::NormalisableRange<double> sliderRange { static_cast<double> (range.start), static_cast<double> (range.end),
+                                                      std::move (convertFrom0To1), std::move (convertTo0To1), std::move (snapToLegalValue) };
+        sliderRange.interval = range.interval;
+        sliderRange.skew = range.skew;
+        sliderRange.symmetricSkew = range.symmetricSkew;
+        slider.setNormalisableRange (sliderRange);
+
+        // The initial value is shown right away, not on the first vblank.
+        attachment.sendInitialUpdate();
+        coordinator.remove (*this);
+        applyPendingValue();
+
+        slider.addListener (this);
+    }
+
+    ~CoalescedSliderAttachment() override
+    {
+        slider.removeListener (this);
+        coordinator.remove (*this);
+    }
+
+    void applyPendingValue() override
+    {
+        const juce::ScopedValueSetter<bool> ignore (ignoreCallbacks, true);
+        slider.setValue (mPendingValue, juce::sendNotificationSync);
+    }
+
+private:
+    void sliderValueChanged (juce::Slider*) override
+    {
+        if (!ignoreCallbacks)
+            attachment.setValueAsPartOfGesture (static_cast<float> (slider.getValue()));
+    }
+
+    void sliderDragStarted (juce::Slider*) override { attachment.beginGesture(); }
+    void sliderDragEnded (juce::Slider*) override { attachment.endGesture(); }
+
+    juce::Slider& slider;
+    RepaintCoordinator& coordinator;
+    juce::RangedAudioParameter& parameter;
+    juce::ParameterAttachment attachment;
+
+    float mPendingValue = 0.0f;
+    bool ignoreCallbacks = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoalescedSliderAttachment)
+};
+
+/**
+ * @brief Same as juce::AudioProcessorValueTreeState::ButtonAttachment,
+ *        except that the button only follows the parameter once per
+ *        vblank, through the RepaintCoordinator.
+ */
+class CoalescedButtonAttachment : public CoalescedAttachment,
+                                  private juce::Button::Listener
+{
+public:
+    CoalescedButtonAttachment (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, juce::Button& b, RepaintCoordinator& repaintCoordinator)
+        : button (b),
+          coordinator (repaintCoordinator),
+          attachment (*apvts.getParameter (parameterID), [this] (float newValue) { mPendingValue = newValue; coordinator.markPending (*this); }, apvts.undoManager)
+    {
+        attachment.sendInitialUpdate();
+        coordinator.remove (*this);
+        applyPendingValue();
+
+        button.addListener (this);
+    }
+
+    ~CoalescedButtonAttachment() override
+    {
+        button.removeListener (this);
+        coordinator.remove (*this);
+    }
+
+    void applyPendingValue() override
+    {
+        const juce::ScopedValueSetter<bool> ignore (ignoreCallbacks, true);
+        button.setToggleState (mPendingValue >= 0.5f, juce::sendNotificationSync);
+    }
+
+private:
+    void buttonClicked (juce::Button*) override
+    {
+        if (!ignoreCallbacks)
+            attachment.setValueAsCompleteGesture (button.getToggleState() ? 1.0f : 0.0f);
+    }
+
+    juce::Button& button;
+    RepaintCoordinator& coordinator;
+    juce::ParameterAttachment attachment;
+
+    float mPendingValue = 0.0f;
+    bool ignoreCallbacks = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoalescedButtonAttachment)
+};
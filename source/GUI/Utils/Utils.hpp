@@ -3,6 +3,7 @@
 #include "juce_core/juce_core.h"
 #include "juce_graphics/juce_graphics.h"
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -16,6 +17,85 @@ namespace Utils
                                                                                                         .getChildFile(JucePlugin_Manufacturer)
                                                                                                         .getChildFile(JucePlugin_Name)
                                                                                                         .getChildFile("Presets"));
+
+    /**
+     * @brief The plugin's typefaces. They're looked up in the system's
+     *        font list the first time they're needed, then kept until
+     *        shutdown: opening another editor doesn't resolve them again.
+     *        Message thread only.
+     */
+    class Fonts : private juce::DeletedAtShutdown
+    {
+    public:
+        ~Fonts() override { clearSingletonInstance(); }
+
+        /**
+         * @brief JetBrainsMono NFM Bold, used by every label and knob.
+         */
+        static juce::FontOptions get (float height)
+        {
+            return juce::FontOptions (getInstance()->mono).withHeight (height);
+        }
+
+        /**
+         * @brief JetBrainsMono Nerd Font Bold, used by the plugin's name.
+         */
+        static juce::FontOptions getTitle (float height)
+        {
+            return juce::FontOptions (getInstance()->title).withHeight (height);
+        }
+
+        JUCE_DECLARE_SINGLETON_INLINE (Fonts, false)
+
+    private:
+        Fonts() = default;
+
+        juce::Typeface::Ptr mono  { juce::Font (juce::FontOptions ("JetBrainsMono NFM", "Bold", 18.0f)).getTypefacePtr() };
+        juce::Typeface::Ptr title { juce::Font (juce::FontOptions ("JetBrainsMono Nerd Font", "Bold", 60.0f)).getTypefacePtr() };
+    };
+
+    /**
+     * @brief The outlined text of the labels, laid out once and shared by
+     *        every CompAndLabel through a juce::SharedResourcePointer.
+     *        Keyed by text, font and bounds. Message thread only.
+     */
+    class GlyphPathCache
+    {
+    public:
+        struct Entry
+        {
+            juce::Path glyphs;  // the text
+            juce::Path stroke;  // its outline, already stroked
+        };
+
+        std::shared_ptr<const Entry> get (const juce::Font& font, const juce::String& text, juce::Rectangle<int> bounds, float strokeThickness)
+        {
+            const auto key = text + "|" + font.toString() + "|" + juce::String (font.getExtraKerningFactor())
+                             + "|" + bounds.toString() + "|" + juce::String (strokeThickness);
+
+            if (auto cached = entries.find (key); cached != entries.end())
+                return cached->second;
+
+            // Labels only ever have a few sizes, this is just a safety net.
+            if (entries.size() > 256)
+                entries.clear();
+
+            auto entry = std::make_shared<Entry>();
+            juce::GlyphArrangement arrangement;
+            arrangement.addFittedText (font, text,
+                                       (float) bounds.getX(), (float) bounds.getY(),
+                                       (float) bounds.getWidth(), (float) bounds.getHeight(),
+                                       juce::Justification::horizontallyCentred | juce::Justification::verticallyCentred, 1);
+            arrangement.createPath (entry->glyphs);
+            juce::PathStrokeType (strokeThickness).createStrokedPath (entry->stroke, entry->glyphs);
+
+            entries.emplace (key, entry);
+            return entry;
+        }
+
+    private:
+        std::map<juce::String, std::shared_ptr<const Entry>> entries;
+    };
 }
 
 
@@ -34,25 +114,28 @@ public:
 
     void paint(juce::Graphics& g) override
     {
+        // Text layout only happens again when the text or the bounds change.
+        const auto bounds = label.getBoundsInParent();
+        if (glyphPath == nullptr || bounds != glyphPathBounds || label.getText() != glyphPathText)
+        {
+            glyphPath = glyphPathCache->get(label.getFont(), label.getText(), bounds, 4.0f);
+            glyphPathBounds = bounds;
+            glyphPathText = label.getText();
+        }
 
-        juce::Path glyphPath;
-        juce::GlyphArrangement glyphs;
-        glyphs.addFittedText(label.getFont(), label.getText(), 
-                             label.getBoundsInParent().getTopLeft().x, 
-                             label.getBoundsInParent().getTopLeft().y, 
-                             label.getBoundsInParent().getWidth(), 
-                             label.getBoundsInParent().getHeight(), 
-                             juce::Justification::horizontallyCentred | juce::Justification::verticallyCentred, 1);
-        glyphs.createPath(glyphPath);
-        
         g.setColour(juce::Colours::white);
-        juce::PathStrokeType strokeType(4.0f);
-        g.strokePath(glyphPath, strokeType);
-        g.fillPath(glyphPath);
+        g.fillPath(glyphPath->stroke);
+        g.fillPath(glyphPath->glyphs);
     }
 protected:
-    juce::FontOptions fontOptions {"JetBrainsMono NFM", "Bold", 18.0f};
+    juce::FontOptions fontOptions = Utils::Fonts::get(18.0f);
     juce::Label label;
+
+private:
+    juce::SharedResourcePointer<Utils::GlyphPathCache> glyphPathCache;
+    std::shared_ptr<const Utils::GlyphPathCache::Entry> glyphPath;
+    juce::Rectangle<int> glyphPathBounds;
+    juce::String glyphPathText;
 };
 
 
@@ -0,0 +1,100 @@
+#include "VisualizerComponent.hpp"
+#include "juce_graphics/juce_graphics.h"
+
+VisualizerComponent::VisualizerComponent (VisualizerFifo& fifo) : visualizerFifo (fifo)
+{
+    setOpaque (true);
+    visualizerFifo.setEditorAttached (true);
+}
+
+VisualizerComponent::~VisualizerComponent()
+{
+    visualizerFifo.setEditorAttached (false);
+}
+
+void VisualizerComponent::update()
+{
+    const auto hasNewFrame = visualizerFifo.pull (mFrame);
+
+    // about 20dB per second of fall back at 60Hz
+    constexpr auto fallBack = 0.94f;
+    auto isMoving = false;
+
+    for (size_t channel = 0; channel < mDisplayedPeak.size(); ++channel)
+    {
+        const auto peak = hasNewFrame ? mFrame.peak[channel] : 0.0f;
+        const auto rms = hasNewFrame ? mFrame.rms[channel] : 0.0f;
+
+        const auto newPeak = juce::jmax (peak, mDisplayedPeak[channel] * fallBack);
+        const auto newRms = juce::jmax (rms, mDisplayedRms[channel] * fallBack);
+
+        isMoving = isMoving || newPeak > 0.001f || mDisplayedPeak[channel] > 0.001f;
+
+        mDisplayedPeak[channel] = newPeak < 0.001f ? 0.0f : newPeak;
+        mDisplayedRms[channel] = newRms < 0.001f ? 0.0f : newRms;
+    }
+
+    if (hasNewFrame || isMoving)
+        repaint();
+}
+
+void VisualizerComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (mBackgroundColour);
+
+    auto area = getLocalBounds().toFloat().reduced (6.0f);
+    auto metersArea = area.removeFromRight (24.0f);
+    area.removeFromRight (6.0f);
+
+    /*
+     * Delay buffer, mirrored around the middle
+     */
+    const auto middle = area.getCentreY();
+    const auto halfHeight = area.getHeight() * 0.5f;
+    const auto pointWidth = area.getWidth() / static_cast<float> (VisualizerFrame::numDelayPoints);
+
+    juce::RectangleList<float> bars;
+    for (int point = 0; point < VisualizerFrame::numDelayPoints; ++point)
+    {
+        const auto height = juce::jlimit (0.0f, 1.0f, mFrame.delayView[static_cast<size_t> (point)]) * halfHeight;
+        if (height > 0.5f)
+            bars.addWithoutMerging ({ area.getX() + static_cast<float> (point) * pointWidth, middle - height, juce::jmax (1.0f, pointWidth - 1.0f), 2.0f * height });
+    }
+
+    g.setColour (juce::Colour::fromRGB (50, 222, 138));
+    g.fillRectList (bars);
+
+    // The echoes come out of the read head.
+    g.setColour (juce::Colour::fromRGB (225, 90, 151));
+    g.fillRect (area.getX() + mFrame.readHead * area.getWidth() - 1.0f, area.getY(), 2.0f, area.getHeight());
+
+    g.setColour (juce::Colours::white);
+    g.fillRect (area.getX() + mFrame.writeHead * area.getWidth() - 1.0f, area.getY(), 2.0f, area.getHeight());
+
+    /*
+     * Meters
+     */
+    const auto meterWidth = metersArea.getWidth() / static_cast<float> (VisualizerFrame::maxChannels);
+    for (size_t channel = 0; channel < mDisplayedPeak.size(); ++channel)
+        paintMeter (g, metersArea.removeFromLeft (meterWidth).reduced (1.0f, 0.0f), mDisplayedPeak[channel], mDisplayedRms[channel]);
+}
+
+void VisualizerComponent::paintMeter (juce::Graphics& g, juce::Rectangle<float> area, float peak, float rms) const
+{
+    // -60dB to 0dB
+    const auto toHeight = [&area] (float level)
+    {
+        const auto decibels = juce::Decibels::gainToDecibels (level, -60.0f);
+        return juce::jmap (decibels, -60.0f, 0.0f, 0.0f, area.getHeight());
+    };
+
+    g.setColour (juce::Colour::fromRGB (46, 32, 45));
+    g.fillRect (area);
+
+    g.setColour (juce::Colour::fromRGB (50, 222, 138));
+    g.fillRect (area.withTop (area.getBottom() - juce::jmin (area.getHeight(), toHeight (rms))));
+
+    g.setColour (peak >= 1.0f ? juce::Colour::fromRGB (225, 90, 151) : juce::Colours::white);
+    const auto peakY = area.getBottom() - juce::jmin (area.getHeight(), toHeight (peak));
+    g.fillRect (area.getX(), peakY, area.getWidth(), 2.0f);
+}
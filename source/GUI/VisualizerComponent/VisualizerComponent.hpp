@@ -0,0 +1,45 @@
+#pragma once
+
+#include "juce_gui_basics/juce_gui_basics.h"
+
+#include "../../Visualizer/VisualizerFifo.hpp"
+
+/**
+ * @brief Output meters (peak and RMS) and a view of the delay
+ *        buffer with its write and read heads. Pulls from the
+ *        processor's VisualizerFifo once per vblank, and only
+ *        repaints when a new frame came in.
+ */
+class VisualizerComponent : public juce::Component
+{
+public:
+    VisualizerComponent (VisualizerFifo& fifo);
+
+    ~VisualizerComponent() override;
+
+    void paint (juce::Graphics& g) override;
+
+private:
+    /**
+     * @brief Called on every vblank. Pulls the newest frame,
+     *        lets the meters fall back, and repaints.
+     */
+    void update();
+
+    /**
+     * @brief Draws a meter, RMS filled and peak as a line.
+     */
+    void paintMeter (juce::Graphics& g, juce::Rectangle<float> area, float peak, float rms) const;
+
+    VisualizerFifo& visualizerFifo;
+    VisualizerFrame mFrame;
+
+    // What the meters show, falling back slower than the audio does.
+    std::array<float, VisualizerFrame::maxChannels> mDisplayedPeak {}, mDisplayedRms {};
+
+    juce::Colour mBackgroundColour { juce::Colour::fromRGB (36, 22, 35) };
+
+    juce::VBlankAttachment vBlankAttachment { this, [this]() { update(); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VisualizerComponent)
+};
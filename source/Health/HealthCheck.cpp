@@ -0,0 +1,29 @@
+#include "HealthCheck.hpp"
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace HealthCheck
+{
+    bool isHealthy (const float* data, int numSamples, float limit)
+    {
+        jassert (limit >= 0.0f && limit <= std::numeric_limits<float>::max());
+
+        const auto limitBits = std::bit_cast<std::uint32_t> (limit);
+        std::uint32_t loudest = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+            loudest = juce::jmax (loudest, std::bit_cast<std::uint32_t> (data[i]) & 0x7fffffffu);
+
+        return loudest <= limitBits;
+    }
+
+    bool isHealthy (const juce::dsp::AudioBlock<float>& block, float limit)
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            if (!isHealthy (block.getChannelPointer (channel), static_cast<int> (block.getNumSamples()), limit))
+                return false;
+
+        return true;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef HEALTHCHECK_HPP
+#define HEALTHCHECK_HPP
+
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+
+/**
+ * @brief Cheap checks for NaN, infinities and runaway levels, to be run
+ *        once per block on what a feedback loop just wrote.
+ *
+ *        Fast-math lets the compiler assume there are no NaNs nor infinities,
+ *        std::isfinite() may well be optimised into true. These look at the
+ *        bits instead: with the sign cleared, a float's bits grow with its
+ *        magnitude and the non-finite ones come last. One integer max per
+ *        sample, which vectorises.
+ */
+namespace HealthCheck
+{
+    // +60dBFS, far beyond anything but a feedback running away.
+    constexpr float runawayLevel = 1000.0f;
+
+    /**
+     * @brief true if every sample is finite, with a magnitude of at most limit.
+     */
+    bool isHealthy (const float* data, int numSamples, float limit = runawayLevel);
+
+    /**
+     * @brief Same, for every channel of block.
+     */
+    bool isHealthy (const juce::dsp::AudioBlock<float>& block, float limit = runawayLevel);
+}
+
+#endif
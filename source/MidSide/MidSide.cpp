@@ -0,0 +1,162 @@
+#include "MidSide.hpp"
+#include "juce_audio_processors/juce_audio_processors.h"
+#include <memory>
+
+MidSide::MidSide (juce::AudioProcessorValueTreeState& valueTree) : apvts (valueTree),
+                                                                   mWidthParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Stereo Width"))),
+                                                                   mMidGainParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Mid Gain"))),
+                                                                   mSideGainParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Side Gain"))),
+                                                                   mBassMonoFrequencyParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Bass Mono Frequency")))
+{
+}
+
+void MidSide::prepare (const juce::dsp::ProcessSpec& specs)
+{
+    mSampleRate = specs.sampleRate;
+
+    // 20ms ramps
+    mMidGain.reset (mSampleRate, 0.02);
+    mSideGain.reset (mSampleRate, 0.02);
+
+    mSideHighPass.setType (juce::dsp::LinkwitzRileyFilterType::highpass);
+    mSideHighPass.prepare ({ specs.sampleRate, specs.maximumBlockSize, 1 });
+
+    // Starts from the current values, the first block doesn't ramp from the defaults.
+    setParameters (dumpParametersFromAPVTS());
+    reset();
+}
+
+void MidSide::reset()
+{
+    mMidGain.setCurrentAndTargetValue (mParameters.midGain);
+    mSideGain.setCurrentAndTargetValue (mParameters.sideGain * mParameters.width);
+    mSideHighPass.reset();
+    mBassMonoWasActive = false;
+}
+
+MidSide::Parameters MidSide::dumpParametersFromAPVTS() const
+{
+    Parameters tempParams;
+
+    tempParams.width             = mWidthParameter->get();
+    tempParams.midGain           = mMidGainParameter->get();
+    tempParams.sideGain          = mSideGainParameter->get();
+    tempParams.bassMonoFrequency = mBassMonoFrequencyParameter->get();
+
+    return tempParams;
+}
+
+void MidSide::setParameters (const Parameters& newParameters)
+{
+    mParameters = newParameters;
+    // The crossover has to stay well below Nyquist.
+    mParameters.bassMonoFrequency = juce::jlimit (mBassMonoFrequencyParameter->range.start, mBassMonoFrequencyParameter->range.end, mParameters.bassMonoFrequency);
+}
+
+void MidSide::process (juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto&& block = context.getOutputBlock();
+    if (block.getNumChannels() != 2)
+        return;
+
+    auto* left = block.getChannelPointer (0);
+    auto* right = block.getChannelPointer (1);
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+
+    mMidGain.setTargetValue (mParameters.midGain);
+    mSideGain.setTargetValue (mParameters.sideGain * mParameters.width);
+
+    // At the defaults (unity mid and side, no bass mono) this stage is the identity.
+    const auto bassMono = mParameters.bassMonoFrequency > mBassMonoFrequencyParameter->range.start;
+    if (bassMono)
+    {
+        if (!mBassMonoWasActive)
+            mSideHighPass.reset();
+
+        mSideHighPass.setCutoffFrequency (mParameters.bassMonoFrequency);
+    }
+    mBassMonoWasActive = bassMono;
+
+    if (bassMono || mMidGain.isSmoothing() || mSideGain.isSmoothing())
+    {
+        // Encode, filter and decode in one go, one sample at a time.
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto mid = 0.5f * mMidGain.getNextValue() * (left[i] + right[i]);
+            auto side = 0.5f * mSideGain.getNextValue() * (left[i] - right[i]);
+
+            if (bassMono)
+                side = mSideHighPass.processSample (0, side);
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+
+        if (bassMono)
+            mSideHighPass.snapToZero();
+        return;
+    }
+
+    const auto mid = mMidGain.getTargetValue();
+    const auto side = mSideGain.getTargetValue();
+
+    if (juce::approximatelyEqual (mid, 1.0f) && juce::approximatelyEqual (side, 1.0f))
+        return;
+
+    const auto diagonal = 0.5f * (mid + side);
+    const auto antiDiagonal = 0.5f * (mid - side);
+    applyMatrix (left, right, numSamples, diagonal, antiDiagonal, antiDiagonal, diagonal);
+}
+
+void MidSide::applyMatrix (float* left, float* right, int numSamples, float a, float b, float c, float d)
+{
+    int i = 0;
+
+#if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr auto vecSize = static_cast<int> (Vec::size());
+
+    // AudioBuffer channels share the same alignment, so once left
+    // is aligned right is too, unless the host gave us its own buffers.
+    while (i < numSamples && !Vec::isSIMDAligned (left + i))
+    {
+        const auto l = left[i], r = right[i];
+        left[i] = a * l + b * r;
+        right[i] = c * l + d * r;
+        ++i;
+    }
+
+    if (Vec::isSIMDAligned (right + i))
+    {
+        const auto va = Vec::expand (a), vb = Vec::expand (b);
+        const auto vc = Vec::expand (c), vd = Vec::expand (d);
+
+        for (; i + vecSize <= numSamples; i += vecSize)
+        {
+            const auto l = Vec::fromRawArray (left + i);
+            const auto r = Vec::fromRawArray (right + i);
+            (va * l + vb * r).copyToRawArray (left + i);
+            (vc * l + vd * r).copyToRawArray (right + i);
+        }
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+    {
+        const auto l = left[i], r = right[i];
+        left[i] = a * l + b * r;
+        right[i] = c * l + d * r;
+    }
+}
+
+void MidSide::AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Stereo Width", "Stereo Width", juce::NormalisableRange<float> (0.0f, 2.0f, 0.01f), 1.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Mid Gain", "Mid Gain", juce::NormalisableRange<float> (0.0f, 1.5f, 0.01f), 1.0f));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Side Gain", "Side Gain", juce::NormalisableRange<float> (0.0f, 1.5f, 0.01f), 1.0f));
+
+    // 20Hz (the minimum) means off
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Bass Mono Frequency", "Bass Mono Frequency", juce::NormalisableRange<float> (20.0f, 500.0f, 1.0f, 0.5f), 20.0f));
+}
@@ -0,0 +1,101 @@
+#ifndef MIDSIDE_HPP
+#define MIDSIDE_HPP
+
+#include "juce_audio_processors/juce_audio_processors.h"
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+
+/**
+ * @brief Stereo width and mid/side stage, placed after the dry/wet mixer.
+ *
+ *        Without bass mono, encoding, mid and side gains and decoding
+ *        fold into a single 2x2 matrix applied in one SIMD pass
+ *        (sample by sample while the gains are ramping):
+ *            L' = a.L + b.R,  R' = b.L + a.R
+ *        with a = (mid + side) / 2 and b = (mid - side) / 2.
+ *        With bass mono, the side channel goes through a 4th order
+ *        Linkwitz-Riley high-pass, so that encoding, filtering and
+ *        decoding run in one loop, sample by sample.
+ */
+class MidSide
+{
+public:
+    /**
+     * @brief Holds the values the stage works with during a block.
+     *        Mirrors Delay::Parameters.
+     */
+    struct Parameters
+    {
+        float width             = 1.0f;  // Stereo Width
+        float midGain           = 1.0f;  // Mid Gain
+        float sideGain          = 1.0f;  // Side Gain
+        float bassMonoFrequency = 20.0f; // Bass Mono Frequency, 20Hz is off
+    };
+
+    MidSide(juce::AudioProcessorValueTreeState& valueTree);
+
+    /**
+     * @brief To be called inside the PluginProcessor::prepareToPlay method
+     *
+     * @param specs the juce::dsp::ProcessSpec related to this processor.
+     */
+    void prepare(const juce::dsp::ProcessSpec& specs);
+
+    /**
+     * @brief Clears the crossover filter and snaps the gains to their targets.
+     */
+    void reset();
+
+    /**
+     * @brief Reads the current values of the mid/side parameters in the APVTS.
+     */
+    Parameters dumpParametersFromAPVTS() const;
+
+    /**
+     * @brief Sets the values used by the next process(). To be called once
+     *        per block, either with dumpParametersFromAPVTS() or with values
+     *        computed elsewhere (e.g. by the PresetMorph).
+     */
+    void setParameters(const Parameters& newParameters);
+
+    /**
+     * @brief To be called within PluginProcessor::processBlock method, after
+     *        setParameters(). Does nothing on anything but a stereo block.
+     */
+    void process(juce::dsp::ProcessContextReplacing<float>& context);
+
+    /**
+     * @brief Appends the list of parameters needed by this class to the main APVTS
+     *
+     * @param layout the main APVTS o the plugin
+     */
+    void AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+private:
+    /**
+     * @brief L' = a.L + b.R, R' = c.L + d.R, in place.
+     */
+    static void applyMatrix (float* left, float* right, int numSamples, float a, float b, float c, float d);
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    juce::AudioParameterFloat* mWidthParameter = nullptr;
+    juce::AudioParameterFloat* mMidGainParameter = nullptr;
+    juce::AudioParameterFloat* mSideGainParameter = nullptr;
+    juce::AudioParameterFloat* mBassMonoFrequencyParameter = nullptr;
+
+    Parameters mParameters;
+
+    // Smoothed per sample, the SIMD matrix is used once they've settled.
+    juce::SmoothedValue<float> mMidGain, mSideGain;
+
+    // Everything below the crossover ends up mono. Cleared when bass mono is switched on.
+    juce::dsp::LinkwitzRileyFilter<float> mSideHighPass;
+    bool mBassMonoWasActive = false;
+
+    double mSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidSide)
+};
+
+#endif
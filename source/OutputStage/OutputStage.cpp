@@ -0,0 +1,148 @@
+#include "OutputStage.hpp"
+#include <algorithm>
+
+void OutputStage::prepare (const juce::dsp::ProcessSpec& specs, int maxDryLatency)
+{
+    mHistoryLength = juce::jmax (0, maxDryLatency);
+    mDryBuffer.setSize (static_cast<int> (specs.numChannels), mHistoryLength + static_cast<int> (specs.maximumBlockSize), false, false, true);
+    mDryLatency = juce::jmin (mDryLatency, mHistoryLength);
+    mMixRampLength = juce::jmax (1, juce::roundToInt (mixRampSeconds * specs.sampleRate));
+
+    reset();
+}
+
+void OutputStage::reset()
+{
+    mDryBuffer.clear();
+    mDryCaptured = false;
+
+    mMix = mMixTarget;
+    mMixStep = 0.0f;
+    mMixCountdown = 0;
+    mGain = mGainTarget;
+}
+
+void OutputStage::setParameters (float mix, float level, float gain)
+{
+    if (mix != mMixTarget)
+    {
+        mMixTarget = mix;
+        mMixCountdown = mMixRampLength;
+        mMixStep = (mMixTarget - mMix) / static_cast<float> (mMixRampLength);
+    }
+
+    mGainTarget = level * gain;
+}
+
+void OutputStage::setDryLatency (int numSamples)
+{
+    jassert (numSamples <= mHistoryLength);
+    mDryLatency = juce::jlimit (0, mHistoryLength, numSamples);
+}
+
+void OutputStage::captureDry (const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), mDryBuffer.getNumChannels());
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    jassert (numSamples <= mDryBuffer.getNumSamples() - mHistoryLength);
+
+    // Fully wet for the whole block, the dry signal is only needed as history.
+    mDryCaptured = !isFullyWet();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* input = block.getChannelPointer (static_cast<size_t> (channel));
+        auto* dry = mDryBuffer.getWritePointer (channel);
+
+        if (mDryCaptured)
+        {
+            juce::FloatVectorOperations::copy (dry + mHistoryLength, input, numSamples);
+        }
+        else if (numSamples >= mHistoryLength)
+        {
+            juce::FloatVectorOperations::copy (dry, input + numSamples - mHistoryLength, mHistoryLength);
+        }
+        else
+        {
+            std::copy (dry + numSamples, dry + mHistoryLength, dry);
+            juce::FloatVectorOperations::copy (dry + mHistoryLength - numSamples, input, numSamples);
+        }
+    }
+}
+
+void OutputStage::process (juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto&& block = context.getOutputBlock();
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), mDryBuffer.getNumChannels());
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+
+    if (numSamples == 0)
+        return;
+
+    const auto gainStart = mGain;
+    const auto gainStep = (mGainTarget - mGain) / static_cast<float> (numSamples);
+    mGain = mGainTarget;
+
+    if (!mDryCaptured)
+    {
+        if (gainStep != 0.0f || gainStart != 1.0f)
+            for (int channel = 0; channel < numChannels; ++channel)
+                applyRamp (block.getChannelPointer (static_cast<size_t> (channel)), numSamples, gainStart, gainStep);
+
+        return;
+    }
+
+    // At most two segments: the end of the mix ramp, then a steady mix.
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = mMixCountdown > 0 ? juce::jmin (numSamples - start, mMixCountdown) : numSamples - start;
+        const auto mixEnd = mMixCountdown > 0 ? (length == mMixCountdown ? mMixTarget : mMix + mMixStep * static_cast<float> (length)) : mMix;
+
+        const auto segmentGainStart = gainStart + gainStep * static_cast<float> (start);
+        const auto segmentGainEnd = gainStart + gainStep * static_cast<float> (start + length);
+
+        const auto wetStart = mMix * segmentGainStart;
+        const auto wetStep = (mixEnd * segmentGainEnd - wetStart) / static_cast<float> (length);
+        const auto dryStart = (1.0f - mMix) * segmentGainStart;
+        const auto dryStep = ((1.0f - mixEnd) * segmentGainEnd - dryStart) / static_cast<float> (length);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* output = block.getChannelPointer (static_cast<size_t> (channel)) + start;
+            const auto* dry = mDryBuffer.getReadPointer (channel) + mHistoryLength - mDryLatency + start;
+            mixWithRamps (output, dry, length, wetStart, wetStep, dryStart, dryStep);
+        }
+
+        mMix = mixEnd;
+        mMixCountdown = juce::jmax (0, mMixCountdown - length);
+        start += length;
+    }
+
+    // The end of this block is the next one's history.
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* dry = mDryBuffer.getWritePointer (channel);
+        std::copy (dry + numSamples, dry + numSamples + mHistoryLength, dry);
+    }
+}
+
+void OutputStage::mixWithRamps (float* output, const float* dry, int numSamples, float wetGain, float wetStep, float dryGain, float dryStep)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto index = static_cast<float> (i);
+        output[i] = output[i] * (wetGain + wetStep * index) + dry[i] * (dryGain + dryStep * index);
+    }
+}
+
+void OutputStage::applyRamp (float* output, int numSamples, float gain, float step)
+{
+    if (step == 0.0f)
+    {
+        juce::FloatVectorOperations::multiply (output, gain, numSamples);
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+        output[i] *= gain + step * static_cast<float> (i);
+}
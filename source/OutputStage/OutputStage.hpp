@@ -0,0 +1,94 @@
+#ifndef OUTPUTSTAGE_HPP
+#define OUTPUTSTAGE_HPP
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+
+/**
+ * @brief The dry/wet mix, the output level and the output gain, in one pass.
+ *
+ *        The mix ramps over 50ms like juce::dsp::DryWetMixer's (linear rule),
+ *        level and gain over each block. Both fold into a wet and a dry gain,
+ *        each a linear ramp, so that every output sample costs two
+ *        multiply-adds:
+ *            out = wet * (mix * level * gain) + dry * ((1 - mix) * level * gain)
+ *        The dry signal is kept after a short history, for the wet latency,
+ *        in a buffer of its own. Fully wet, it isn't copied at all, only the
+ *        history is kept up to date.
+ */
+class OutputStage
+{
+public:
+    OutputStage() = default;
+
+    /**
+     * @brief To be called inside the PluginProcessor::prepareToPlay method,
+     *        after setParameters() so that reset() snaps to its values.
+     *
+     * @param specs the juce::dsp::ProcessSpec related to this processor.
+     * @param maxDryLatency the most setDryLatency() will be given
+     */
+    void prepare (const juce::dsp::ProcessSpec& specs, int maxDryLatency);
+
+    /**
+     * @brief Clears the dry signal's history, the ramps jump to their targets.
+     */
+    void reset();
+
+    /**
+     * @brief To be called once per block, before captureDry().
+     *
+     * @param mix the proportion of the wet signal, 0 to 1
+     * @param level the output level
+     * @param gain the output gain, multiplied with the level
+     */
+    void setParameters (float mix, float level, float gain);
+
+    /**
+     * @brief How much the dry signal is delayed, to line up with a late wet signal.
+     */
+    void setDryLatency (int numSamples);
+
+    /**
+     * @brief Keeps the dry signal, before anything processes the block.
+     */
+    void captureDry (const juce::dsp::AudioBlock<float>& block);
+
+    /**
+     * @brief Mixes the wet signal in place with the dry signal of the
+     *        last captureDry(), with the level and the gain applied.
+     */
+    void process (juce::dsp::ProcessContextReplacing<float>& context);
+
+private:
+    static constexpr double mixRampSeconds = 0.05;
+
+    /**
+     * @brief output[i] = output[i] * (wetGain + i * wetStep) + dry[i] * (dryGain + i * dryStep)
+     */
+    static void mixWithRamps (float* output, const float* dry, int numSamples, float wetGain, float wetStep, float dryGain, float dryStep);
+
+    /**
+     * @brief output[i] *= gain + i * step
+     */
+    static void applyRamp (float* output, int numSamples, float gain, float step);
+
+    bool isFullyWet() const { return mMixCountdown == 0 && mMix >= 1.0f; }
+
+    // Per channel: mHistoryLength samples of the previous blocks, then the current block.
+    juce::AudioBuffer<float> mDryBuffer;
+    int mHistoryLength = 0;
+    int mDryLatency = 0;
+    bool mDryCaptured = false;
+
+    int mMixRampLength = 1;
+    float mMix = 1.0f, mMixTarget = 1.0f, mMixStep = 0.0f;
+    int mMixCountdown = 0; // samples left of the mix ramp
+
+    float mGain = 1.0f, mGainTarget = 1.0f; // level * gain, where the last block ended and where this one ends
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OutputStage)
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "TruePeakLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+TruePeakLimiter::TruePeakLimiter (juce::AudioProcessorValueTreeState& valueTree) : apvts (valueTree),
+                                                                                   mEnabledParameter (dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("Limiter"))),
+                                                                                   mCeilingParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Limiter Ceiling"))),
+                                                                                   mReleaseParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Limiter Release")))
+{
+}
+
+int TruePeakLimiter::getLatencyInSamples (double sampleRate)
+{
+    return interpolationDelay + juce::jmax (1, juce::roundToInt (lookaheadSeconds * sampleRate)) - 1;
+}
+
+const TruePeakLimiter::InterpolationTable& TruePeakLimiter::getInterpolationTable()
+{
+    static const auto table = []()
+    {
+        InterpolationTable taps;
+        constexpr auto pi = juce::MathConstants<double>::pi;
+        constexpr auto halfWidth = 0.5 * numTaps + 0.5; // the window doesn't reach 0 on the outer taps
+
+        for (size_t phase = 0; phase < taps.size(); ++phase)
+        {
+            // Tap j reads the sample j before the newest, the point is between
+            // interpolationDelay and interpolationDelay - 1 samples before it.
+            const auto fraction = static_cast<double> (phase + 1) / oversampling;
+            auto sum = 0.0;
+
+            for (size_t j = 0; j < numTaps; ++j)
+            {
+                const auto distance = interpolationDelay - static_cast<double> (j) - fraction;
+                const auto sinc = std::sin (pi * distance) / (pi * distance);
+                const auto window = 0.5 + 0.5 * std::cos (pi * distance / halfWidth);
+                taps[phase][j] = static_cast<float> (sinc * window);
+                sum += sinc * window;
+            }
+
+            // unity gain at DC
+            for (auto& tap : taps[phase])
+                tap = static_cast<float> (tap / sum);
+        }
+
+        return taps;
+    }();
+
+    return table;
+}
+
+void TruePeakLimiter::prepare (const juce::dsp::ProcessSpec& specs)
+{
+    mSampleRate = specs.sampleRate;
+    mTable = &getInterpolationTable();
+
+    // The blocks only ever grow, prepareToPlay() may be called often.
+    if (static_cast<int> (specs.maximumBlockSize) > mMaximumBlockSize)
+    {
+        mPeaks.allocate (specs.maximumBlockSize, true);
+        mScratch.allocate (specs.maximumBlockSize, true);
+        mMaximumBlockSize = static_cast<int> (specs.maximumBlockSize);
+    }
+
+    const auto lookahead = juce::jmax (1, juce::roundToInt (lookaheadSeconds * mSampleRate));
+    if (lookahead > mLookaheadCapacity)
+    {
+        mDequeValues.allocate (static_cast<size_t> (lookahead + 1), true);
+        mDequeIndices.allocate (static_cast<size_t> (lookahead + 1), true);
+        mAverageRing.allocate (static_cast<size_t> (lookahead), true);
+        mLookaheadCapacity = lookahead;
+    }
+
+    mLookahead = lookahead;
+    mHoldLength = lookahead + 1;
+    mLatency = getLatencyInSamples (mSampleRate);
+
+    mHistory.setSize (static_cast<int> (specs.numChannels), numTaps - 1 + mMaximumBlockSize, false, false, true);
+    mDelayLine.setSize (static_cast<int> (specs.numChannels), mLatency, false, false, true);
+    mDelayScratch.setSize (1, mLatency, false, false, true);
+
+    mEnabled = mEnabledParameter->get();
+
+    reset();
+}
+
+void TruePeakLimiter::reset()
+{
+    mHistory.clear();
+    mDelayLine.clear();
+    mDelayPosition = 0;
+
+    mDequeFront = 0;
+    mDequeSize = 0;
+    mSampleIndex = 0;
+
+    for (int i = 0; i < mLookahead; ++i)
+        mAverageRing[i] = 1.0f;
+    mAveragePosition = 0;
+    mAverageSum = static_cast<double> (mLookahead);
+
+    mGain = 1.0f;
+}
+
+void TruePeakLimiter::process (juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto&& block = context.getOutputBlock();
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), mHistory.getNumChannels());
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    jassert (numSamples <= mMaximumBlockSize);
+
+    // Switching it on or off starts it over, from silence.
+    const auto enabled = mEnabledParameter->get();
+    if (enabled != mEnabled)
+    {
+        mEnabled = enabled;
+        reset();
+    }
+
+    if (!mEnabled || numSamples == 0 || numChannels == 0)
+        return;
+
+    detectPeaks (block, numChannels, numSamples);
+    computeGains (numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = block.getChannelPointer (static_cast<size_t> (channel));
+        delayByLatency (channel, data, numSamples);
+        juce::FloatVectorOperations::multiply (data, mPeaks, numSamples);
+    }
+
+    mDelayPosition = (mDelayPosition + numSamples) % mLatency;
+}
+
+void TruePeakLimiter::detectPeaks (const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples)
+{
+    const auto& table = *mTable;
+    constexpr auto historyLength = numTaps - 1;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* history = mHistory.getWritePointer (channel);
+        const auto* newest = history + historyLength; // newest[i - j] is tap j of sample i
+        juce::FloatVectorOperations::copy (history + historyLength, block.getChannelPointer (static_cast<size_t> (channel)), numSamples);
+
+        // the sample the points follow
+        if (channel == 0)
+            juce::FloatVectorOperations::abs (mPeaks, newest - interpolationDelay, numSamples);
+        else
+        {
+            juce::FloatVectorOperations::abs (mScratch, newest - interpolationDelay, numSamples);
+            juce::FloatVectorOperations::max (mPeaks, mPeaks, mScratch, numSamples);
+        }
+
+        // and the 3 points between it and the next one
+        for (const auto& taps : table)
+        {
+            juce::FloatVectorOperations::multiply (mScratch, newest, taps[0], numSamples);
+            for (int j = 1; j < numTaps; ++j)
+                juce::FloatVectorOperations::addWithMultiply (mScratch, newest - j, taps[static_cast<size_t> (j)], numSamples);
+
+            juce::FloatVectorOperations::abs (mScratch, mScratch, numSamples);
+            juce::FloatVectorOperations::max (mPeaks, mPeaks, mScratch, numSamples);
+        }
+
+        // The end of this block is the next one's history.
+        std::copy (history + numSamples, history + numSamples + historyLength, history);
+    }
+}
+
+void TruePeakLimiter::computeGains (int numSamples)
+{
+    // The gain each peak needs: 1 up to the ceiling, ceiling / peak above it.
+    const auto ceiling = juce::Decibels::decibelsToGain (mCeilingParameter->get());
+    juce::FloatVectorOperations::max (mPeaks, mPeaks, ceiling, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        mPeaks[i] = ceiling / mPeaks[i];
+
+    // Hold, average and release: the one part that has to go sample by sample.
+    const auto release = static_cast<float> (std::exp (-1.0 / (mReleaseParameter->get() * 0.001 * mSampleRate)));
+    const auto averageScale = 1.0 / static_cast<double> (mLookahead);
+    auto gain = mGain;
+
+    for (int i = 0; i < numSamples; ++i, ++mSampleIndex)
+    {
+        const auto value = mPeaks[i];
+
+        // Monotonic deque: the front is the smallest gain of the last mHoldLength samples.
+        if (mDequeSize > 0 && mDequeIndices[mDequeFront] <= mSampleIndex - mHoldLength)
+        {
+            mDequeFront = (mDequeFront + 1) % mHoldLength;
+            --mDequeSize;
+        }
+
+        while (mDequeSize > 0 && mDequeValues[(mDequeFront + mDequeSize - 1) % mHoldLength] >= value)
+            --mDequeSize;
+
+        const auto back = (mDequeFront + mDequeSize) % mHoldLength;
+        mDequeValues[back] = value;
+        mDequeIndices[back] = mSampleIndex;
+        ++mDequeSize;
+
+        const auto held = mDequeValues[mDequeFront];
+
+        mAverageSum += static_cast<double> (held) - static_cast<double> (mAverageRing[mAveragePosition]);
+        mAverageRing[mAveragePosition] = held;
+        if (++mAveragePosition == mLookahead)
+            mAveragePosition = 0;
+
+        const auto average = juce::jmin (1.0f, static_cast<float> (mAverageSum * averageScale));
+
+        // Straight down, back up no faster than the release and never above the average.
+        gain = average < gain ? average : average + release * (gain - average);
+        mPeaks[i] = gain;
+    }
+
+    mGain = gain;
+}
+
+void TruePeakLimiter::delayByLatency (int channel, float* data, int numSamples)
+{
+    auto* line = mDelayLine.getWritePointer (channel);
+    auto* scratch = mDelayScratch.getWritePointer (0);
+    auto position = mDelayPosition;
+
+    // swaps the block with what the line holds, one contiguous run at a time
+    for (int i = 0; i < numSamples;)
+    {
+        const auto length = juce::jmin (numSamples - i, mLatency - position);
+
+        juce::FloatVectorOperations::copy (scratch, data + i, length);
+        juce::FloatVectorOperations::copy (data + i, line + position, length);
+        juce::FloatVectorOperations::copy (line + position, scratch, length);
+
+        i += length;
+        position += length;
+        if (position == mLatency)
+            position = 0;
+    }
+}
+
+void TruePeakLimiter::AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    // Adds TruePeakLimiter::getLatencyInSamples() of latency
+    layout.add (std::make_unique<juce::AudioParameterBool> ("Limiter", "Limiter", false));
+
+    // in dBTP
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Limiter Ceiling", "Limiter Ceiling", juce::NormalisableRange<float> (-12.0f, 0.0f, 0.1f), -1.0f));
+
+    // in ms
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Limiter Release", "Limiter Release", juce::NormalisableRange<float> (10.0f, 1000.0f, 1.0f, 0.4f), 100.0f));
+}
@@ -0,0 +1,133 @@
+#ifndef TRUEPEAKLIMITER_HPP
+#define TRUEPEAKLIMITER_HPP
+
+#include "juce_audio_processors/juce_audio_processors.h"
+#include "juce_core/juce_core.h"
+#include "juce_dsp/juce_dsp.h"
+#include <array>
+
+/**
+ * @brief Lookahead true-peak limiter, the last thing before the output.
+ *
+ *        The peaks are taken 4 times oversampled: the 3 points between
+ *        two samples come from 8-tap polyphase filters, run a tap at a time
+ *        over the whole block with vectorised multiply-adds. The gain each
+ *        peak needs is held for the lookahead and one sample more by a
+ *        sliding minimum (a monotonic deque, O(1) per sample), then
+ *        averaged over the lookahead: the gain is down to what the peak
+ *        needs when it reaches the output, and still is on the next
+ *        sample, the other end of the points between them, without ever
+ *        stepping. The release is a one pole that never goes above that
+ *        average.
+ */
+class TruePeakLimiter
+{
+public:
+    static constexpr double lookaheadSeconds = 0.0015;
+
+    TruePeakLimiter(juce::AudioProcessorValueTreeState& valueTree);
+
+    /**
+     * @brief The latency of the limiter when it's on, at sampleRate.
+     */
+    static int getLatencyInSamples (double sampleRate);
+
+    /**
+     * @brief To be called inside the PluginProcessor::prepareToPlay method
+     *
+     * @param specs the juce::dsp::ProcessSpec related to this processor.
+     */
+    void prepare(const juce::dsp::ProcessSpec& specs);
+
+    /**
+     * @brief Clears the lookahead and the gain, back to unity.
+     */
+    void reset();
+
+    /**
+     * @brief To be called last in PluginProcessor::processBlock. Reads the parameters.
+     */
+    void process(juce::dsp::ProcessContextReplacing<float>& context);
+
+    /**
+     * @brief How late the output is, 0 when the limiter is off.
+     *        Follows the Limiter parameter as of the last process().
+     */
+    int getLatencyInSamples() const { return mEnabled ? mLatency : 0; }
+
+    /**
+     * @brief Appends the list of parameters needed by this class to the main APVTS
+     *
+     * @param layout the main APVTS o the plugin
+     */
+    void AppendToParameterLayout (juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+private:
+    static constexpr int numTaps = 8;                  // per phase of the interpolator
+    static constexpr int interpolationDelay = numTaps / 2; // samples, from the newest tap to the points
+    static constexpr int oversampling = 4;
+
+    using InterpolationTable = std::array<std::array<float, numTaps>, oversampling - 1>;
+
+    /**
+     * @brief The windowed sinc taps of the points 1/4, 2/4 and 3/4 of the
+     *        way between two samples, computed once for every instance.
+     */
+    static const InterpolationTable& getInterpolationTable();
+
+    /**
+     * @brief mPeaks[i] = the highest true peak of the channels, around
+     *        interpolationDelay samples before sample i.
+     */
+    void detectPeaks (const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples);
+
+    /**
+     * @brief Turns mPeaks into the gains to apply, in place.
+     */
+    void computeGains (int numSamples);
+
+    /**
+     * @brief Delays a channel of numSamples by the latency, in place.
+     */
+    void delayByLatency (int channel, float* data, int numSamples);
+
+    juce::AudioProcessorValueTreeState& apvts;
+
+    juce::AudioParameterBool* mEnabledParameter = nullptr;
+    juce::AudioParameterFloat* mCeilingParameter = nullptr;
+    juce::AudioParameterFloat* mReleaseParameter = nullptr;
+
+    const InterpolationTable* mTable = nullptr;
+
+    // Per channel, the last numTaps - 1 samples of the previous block, then the current block.
+    juce::AudioBuffer<float> mHistory;
+    juce::HeapBlock<float> mPeaks, mScratch; // one value per sample of the block
+
+    // Sliding minimum of the gains over mHoldLength samples, in a ring.
+    juce::HeapBlock<float> mDequeValues;
+    juce::HeapBlock<juce::int64> mDequeIndices;
+    int mDequeFront = 0, mDequeSize = 0;
+    juce::int64 mSampleIndex = 0;
+
+    // Moving average of the held gains over the lookahead.
+    juce::HeapBlock<float> mAverageRing;
+    int mAveragePosition = 0;
+    double mAverageSum = 0.0;
+
+    float mGain = 1.0f; // after the release
+
+    juce::AudioBuffer<float> mDelayLine, mDelayScratch;
+    int mDelayPosition = 0;
+
+    int mLookahead = 1;   // the length of the average, in samples
+    int mHoldLength = 2;  // the lookahead and the sample after the peak
+    int mLookaheadCapacity = 0;
+    int mLatency = 0;
+    bool mEnabled = false;
+    int mMaximumBlockSize = 0;
+    double mSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TruePeakLimiter)
+};
+
+#endif
@@ -0,0 +1,123 @@
+#include "RenderThreadPool.hpp"
+#include <thread>
+
+namespace
+{
+    // How many times an idle worker looks for work before going to sleep.
+    constexpr int numSpinsBeforeSleeping = 2000;
+}
+
+class RenderThreadPool::Worker : public juce::Thread
+{
+public:
+    explicit Worker (RenderThreadPool& owner) : juce::Thread ("Render worker"), pool (owner)
+    {
+        startThread (juce::Thread::Priority::high);
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        mWakeUp.signal();
+        stopThread (-1);
+    }
+
+    /**
+     * @brief Called by run() once the jobs are published.
+     */
+    void wakeUpIfSleeping()
+    {
+        if (mSleeping.exchange (false))
+            mWakeUp.signal();
+    }
+
+private:
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            if (pool.runNextJob())
+                continue;
+
+            for (int spin = 0; spin < numSpinsBeforeSleeping && !pool.hasJobsLeft() && !threadShouldExit(); ++spin)
+                std::this_thread::yield();
+
+            if (pool.hasJobsLeft())
+                continue;
+
+            // Published after this point, the jobs come with a signal.
+            mSleeping.store (true);
+            if (!pool.hasJobsLeft() && !threadShouldExit())
+                mWakeUp.wait (-1);
+            mSleeping.store (false);
+        }
+    }
+
+    RenderThreadPool& pool;
+    juce::WaitableEvent mWakeUp;
+    std::atomic<bool> mSleeping { false };
+};
+
+RenderThreadPool::RenderThreadPool (int numWorkers)
+{
+    for (int i = 0; i < numWorkers; ++i)
+        mWorkers.add (new Worker (*this));
+}
+
+RenderThreadPool::~RenderThreadPool()
+{
+    mWorkers.clear();
+}
+
+void RenderThreadPool::runJobs (int numJobs, JobFunction function, void* context)
+{
+    jassert (numJobs >= 0);
+    jassert (!hasJobsLeft() && mRemaining.load() == 0); // run() isn't reentrant
+
+    if (numJobs == 0)
+        return;
+
+    mFunction.store (function, std::memory_order_relaxed);
+    mContext.store (context, std::memory_order_relaxed);
+    mRemaining.store (numJobs, std::memory_order_relaxed);
+    mClaims.store (static_cast<juce::uint64> (numJobs) << 32);
+
+    for (auto* worker : mWorkers)
+        worker->wakeUpIfSleeping();
+
+    while (runNextJob())
+    {
+    }
+
+    // The last jobs may still be running on the workers.
+    while (mRemaining.load (std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+bool RenderThreadPool::runNextJob()
+{
+    auto claims = mClaims.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto numJobs = static_cast<int> (claims >> 32);
+        const auto index = static_cast<int> (claims & 0xffffffff);
+
+        if (index >= numJobs)
+            return false;
+
+        // Claimed, the job can't be finished, nor the next run() published, until we're done with it.
+        if (mClaims.compare_exchange_weak (claims, claims + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            mFunction.load (std::memory_order_relaxed) (mContext.load (std::memory_order_relaxed), index);
+            mRemaining.fetch_sub (1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+bool RenderThreadPool::hasJobsLeft() const
+{
+    const auto claims = mClaims.load();
+    return (claims & 0xffffffff) < (claims >> 32);
+}
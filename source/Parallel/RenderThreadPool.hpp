@@ -0,0 +1,64 @@
+#ifndef RENDERTHREADPOOL_HPP
+#define RENDERTHREADPOOL_HPP
+
+#include "juce_core/juce_core.h"
+#include <atomic>
+
+/**
+ * @brief A handful of worker threads that share the jobs of one call to
+ *        run() with the calling thread, for offline renders with long blocks.
+ *
+ *        Jobs are claimed from a single atomic word (the number of jobs and
+ *        the next one to run): whichever thread is free takes the next job,
+ *        the caller included, so nobody waits on a thread that's late to
+ *        wake up. run() doesn't lock nor allocate, a worker's event is only
+ *        signalled when it went to sleep after a while without work.
+ */
+class RenderThreadPool
+{
+public:
+    /**
+     * @param numWorkers the threads started on top of the one calling run()
+     */
+    explicit RenderThreadPool (int numWorkers);
+    ~RenderThreadPool();
+
+    int getNumWorkers() const { return mWorkers.size(); }
+
+    /**
+     * @brief Calls job (index) for every index from 0 to numJobs - 1, spread
+     *        over the workers and the calling thread, and returns when they're
+     *        all done. Only one thread may call run() at a time.
+     */
+    template <typename Job>
+    void run (int numJobs, Job& job)
+    {
+        runJobs (numJobs, [] (void* context, int index) { (*static_cast<Job*> (context)) (index); }, &job);
+    }
+
+private:
+    using JobFunction = void (*) (void* context, int index);
+
+    class Worker;
+
+    void runJobs (int numJobs, JobFunction function, void* context);
+
+    /**
+     * @brief Claims the next job of the current run() and runs it, false if none was left.
+     */
+    bool runNextJob();
+
+    bool hasJobsLeft() const;
+
+    juce::OwnedArray<Worker> mWorkers;
+
+    // The number of jobs in the high half, the next one to claim in the low half.
+    std::atomic<juce::uint64> mClaims { 0 };
+    std::atomic<int> mRemaining { 0 };
+    std::atomic<JobFunction> mFunction { nullptr };
+    std::atomic<void*> mContext { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderThreadPool)
+};
+
+#endif
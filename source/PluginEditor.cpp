@@ -7,16 +7,20 @@
 
 PluginEditor::PluginEditor (PluginProcessor& p)
     : AudioProcessorEditor (&p), processorRef (p),
-    delayComponent(processorRef.getApvts()),
-    reverbComponent(processorRef.getApvts()),
-    mPluginDryWetSliderAttachement(processorRef.getApvts(), "Plugin Dry Wet", mPluginDryWetSlider.getslider()),
-    mPluginOutputLevelAttachement(processorRef.getApvts(), "Output Level", mPluginOutputLevel.getslider()),
-    mPluginOutputGainAttachement(processorRef.getApvts(), "Output Gain", mPluginOutputGain.getslider()),
-    mPresetManager(processorRef.getApvts())
+    delayComponent(processorRef.getApvts(), mRepaintCoordinator),
+    reverbComponent(processorRef.getApvts(), mRepaintCoordinator),
+    mPluginDryWetSliderAttachement(processorRef.getApvts(), "Plugin Dry Wet", mPluginDryWetSlider.getslider(), mRepaintCoordinator),
+    mPluginOutputLevelAttachement(processorRef.getApvts(), "Output Level", mPluginOutputLevel.getslider(), mRepaintCoordinator),
+    mPluginOutputGainAttachement(processorRef.getApvts(), "Output Gain", mPluginOutputGain.getslider(), mRepaintCoordinator),
+    mPresetMorphSliderAttachement(processorRef.getApvts(), "Preset Morph", mPresetMorphSlider.getslider(), mRepaintCoordinator),
+    mPresetManager(processorRef.getApvts(), processorRef.getPresetMorph(), processorRef.getAuditionPlayer())
 {
     juce::ignoreUnused (processorRef);
 
-    setLookAndFeel(&customLook);
+    setLookAndFeel(&customLook.get());
+
+    // The background layer covers every pixel.
+    setOpaque(true);
 
     #if DEBUG
     addAndMakeVisible (inspectButton);
@@ -33,7 +37,19 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     };
     #endif
 
-    juce::FontOptions options("JetBrainsMono Nerd Font", "Bold", 60);
+    #if DEEEEEE_OPENGL
+    mOpenGLContext.setComponentPaintingEnabled(true);
+    mOpenGLContext.setContinuousRepainting(false);
+
+    mOpenGLButton.setClickingTogglesState(true);
+    mOpenGLButton.setTooltip("Render the interface with OpenGL");
+    mOpenGLButton.onClick = [this]() { setOpenGLRendering(mOpenGLButton.getToggleState()); };
+    addAndMakeVisible(mOpenGLButton);
+
+    setOpenGLRendering(processorRef.getApvts().state.getProperty(PluginProcessor::useOpenGLProperty, false));
+    #endif
+
+    auto options = Utils::Fonts::getTitle(60.0f);
     pluginName.setColour(juce::Label::ColourIds::textColourId, juce::Colour::fromRGB(245, 245, 245));
     pluginName.setFont(juce::Font(options.withKerningFactor(0.40)));
     pluginName.setText("Deeeeee", juce::NotificationType::dontSendNotification);
@@ -45,21 +61,92 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     addAndMakeVisible(mPluginDryWetSlider); 
     addAndMakeVisible(mPluginOutputLevel); 
     addAndMakeVisible(mPluginOutputGain); 
+    addAndMakeVisible(mPresetMorphSlider); 
     addAndMakeVisible(mPresetManager); 
 
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (800, 600);
+    setSize (800, 690);
+
+    // Heavy components that aren't needed to show the editor come later.
+    juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<PluginEditor>(this)]()
+    {
+        if (safeThis != nullptr)
+            safeThis->createVisualizer();
+    });
+}
+
+void PluginEditor::createVisualizer()
+{
+    if (mVisualizer != nullptr)
+        return;
+
+    mVisualizer = std::make_unique<VisualizerComponent>(processorRef.getVisualizerFifo());
+    mVisualizer->setBounds(mVisualizerBounds);
+    addAndMakeVisible(*mVisualizer);
 }
 
 PluginEditor::~PluginEditor()
 {
+    #if DEEEEEE_OPENGL
+    mOpenGLContext.detach();
+    #endif
+
     setLookAndFeel (nullptr);
 }
 
+void PluginEditor::setOpenGLRendering (bool shouldUseOpenGL)
+{
+    #if DEEEEEE_OPENGL
+    processorRef.getApvts().state.setProperty(PluginProcessor::useOpenGLProperty, shouldUseOpenGL, nullptr);
+    mOpenGLButton.setToggleState(shouldUseOpenGL, juce::dontSendNotification);
+
+    if (shouldUseOpenGL && !mOpenGLContext.isAttached())
+        mOpenGLContext.attachTo(*this);
+    else if (!shouldUseOpenGL && mOpenGLContext.isAttached())
+        mOpenGLContext.detach();
+
+    // The cached layers are rendered again by whichever renderer is now in use.
+    mBackgroundCache = {};
+    repaint();
+    #else
+    juce::ignoreUnused(shouldUseOpenGL);
+    #endif
+}
+
 void PluginEditor::paint (juce::Graphics& g)
 {
-    auto area = getBounds();
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (mBackgroundCache.isNull() || !juce::approximatelyEqual (scale, mBackgroundCacheScale))
+    {
+        mBackgroundCacheScale = scale;
+
+        // The layout only depends on the size, so does the background.
+        const auto hash = ("PluginEditor::background " + getLocalBounds().toString() + " " + juce::String (scale)).hashCode64();
+        mBackgroundCache = juce::ImageCache::getFromHashCode (hash);
+
+        if (mBackgroundCache.isNull())
+        {
+            mBackgroundCache = juce::Image (juce::Image::ARGB,
+                                            juce::jmax (1, juce::roundToInt (static_cast<float> (getWidth()) * scale)),
+                                            juce::jmax (1, juce::roundToInt (static_cast<float> (getHeight()) * scale)),
+                                            true);
+
+            juce::Graphics cacheGraphics (mBackgroundCache);
+            cacheGraphics.addTransform (juce::AffineTransform::scale (scale));
+            paintBackground (cacheGraphics);
+
+            juce::ImageCache::addImageToCache (mBackgroundCache, hash);
+        }
+    }
+
+    g.drawImage (mBackgroundCache, getLocalBounds().toFloat());
+}
+
+void PluginEditor::paintBackground (juce::Graphics& g)
+{
+    auto area = getLocalBounds();
 
     /*
      * BACKGROUND RENDERING 
@@ -146,20 +233,48 @@ void PluginEditor::paint (juce::Graphics& g)
     g.setColour(juce::Colour::fromRGB(225, 90, 151));
     g.fillPath(dryWetPath);
 
+    /*
+     * Morph contour and drop shadow 
+     */
+    auto morphPath = juce::Path();
+    morphPath.addRoundedRectangle(mPresetMorphSlider.getBounds(), cornerSize);
+    shadow.drawForPath(g, morphPath);
+    g.setColour(juce::Colours::white);
+    g.strokePath(morphPath, componentStroke);
+    g.setColour(juce::Colour::fromRGB(50, 222, 138));
+    g.fillPath(morphPath);
+
+    /*
+     * Visualizer contour and drop shadow 
+     */
+    auto visualizerPath = juce::Path();
+    visualizerPath.addRoundedRectangle(mVisualizerBounds, cornerSize);
+    shadow.drawForPath(g, visualizerPath);
+    g.setColour(juce::Colours::white);
+    g.strokePath(visualizerPath, componentStroke);
+
 }
 
 void PluginEditor::resized()
 {
+    // Every outline moves with the layout.
+    mBackgroundCache = {};
+
     #if DEBUG
     inspectButton.setBounds (0, 0, 50, 25);
     #endif
 
+    #if DEEEEEE_OPENGL
+    mOpenGLButton.setBounds (getWidth() - 50, 0, 50, 25);
+    #endif
+
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
 
     // Two main areas for utilities and parameters. 
     auto gridArea = getBounds();
     auto utilsArea = gridArea.removeFromTop(120);
+    auto visualizerArea = gridArea.removeFromBottom(90);
 
     /*
      * Utilities grid. 
@@ -216,6 +331,7 @@ void PluginEditor::resized()
 
     parameterGrid.items.set(6, juce::GridItem(delayComponent).withMargin(10));
     parameterGrid.items.set(11, juce::GridItem(reverbComponent).withMargin(10));
+    parameterGrid.items.set(7, juce::GridItem(mPresetMorphSlider).withMargin(10));
     parameterGrid.items.set(8, juce::GridItem(mPluginOutputLevel).withMargin(10));
     parameterGrid.items.set(13, juce::GridItem(mPluginOutputGain).withMargin(10));
     parameterGrid.items.set(12, juce::GridItem(mPluginDryWetSlider).withMargin(10));
@@ -223,5 +339,9 @@ void PluginEditor::resized()
 
     parameterGrid.performLayout (gridArea);
 
+    mVisualizerBounds = visualizerArea.withSizeKeepingCentre(7 * visualizerArea.getWidth() / 8, visualizerArea.getHeight() - 20);
+    if (mVisualizer != nullptr)
+        mVisualizer->setBounds(mVisualizerBounds);
+
 
 }   
\ No newline at end of file
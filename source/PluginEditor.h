@@ -7,10 +7,16 @@
 #include "melatonin_inspector/melatonin_inspector.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#if DEEEEEE_OPENGL
+#include <juce_opengl/juce_opengl.h>
+#endif
+
 #include "GUI/Utils/CustomLookNFeel.hpp"
+#include "GUI/Utils/RepaintCoordinator.hpp"
 #include "GUI/DelayComponent/DelayComponent.hpp"
 #include "GUI/ReverbComponent/ReverbComponent.hpp"
 #include "GUI/PresetManagerComponent/PresetManagerComponent.hpp"
+#include "GUI/VisualizerComponent/VisualizerComponent.hpp"
 
 //==============================================================================
 class PluginEditor : public juce::AudioProcessorEditor
@@ -26,12 +32,46 @@ public:
 private:
 
     /*======================== METHODS ===========================*/
+    /**
+     * @brief Draws the static background: the two triangles, and the
+     *        outline and drop shadow of every component. Only used to
+     *        fill mBackgroundCache, not on every repaint.
+     */
+    void paintBackground (juce::Graphics& g);
+
+    /**
+     * @brief Attaches or detaches the OpenGL context. The choice is kept
+     *        in the APVTS state so that it's restored with the session.
+     */
+    void setOpenGLRendering (bool shouldUseOpenGL);
+
+    /**
+     * @brief Creates the visualizer. Called asynchronously by the
+     *        constructor: the editor opens without waiting for it.
+     */
+    void createVisualizer();
+
     /*======================== MEMBERS ===========================*/
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     PluginProcessor& processorRef;
-    CustomLookNFeel customLook;
+
+    // One LookAndFeel (and so one set of cached knob bodies) for every editor of the process.
+    juce::SharedResourcePointer<CustomLookNFeel> customLook;
+
+    // The background layer, rendered at the display's scale. Invalidated
+    // on resize and rebuilt by paint() when the scale changes. It lives
+    // in juce::ImageCache, shared by every editor of the same size.
+    juce::Image mBackgroundCache;
+    float mBackgroundCacheScale = 0.0f;
     
+    #if DEEEEEE_OPENGL
+    // When attached, the whole editor is painted by OpenGL instead of the
+    // software renderer. Detached (the default), nothing changes.
+    juce::OpenGLContext mOpenGLContext;
+    juce::TextButton mOpenGLButton { "GPU" };
+    #endif
+
     #if DEBUG
     std::unique_ptr<melatonin::Inspector> inspector;
     juce::TextButton inspectButton { "Inspect" };
@@ -39,16 +79,25 @@ private:
 
     juce::Label pluginName;
 
+    // Parameter changes reach the widgets once per vblank, through here.
+    RepaintCoordinator mRepaintCoordinator { *this };
+
     DelayComponent delayComponent;
     ReverbComponent reverbComponent;
     SliderAndLabel mPluginDryWetSlider {  "DRY | WET" },
                    mPluginOutputLevel  {  "OUT::LVL"  },
-                   mPluginOutputGain   {  "OUT::GAI"  };
-    juce::AudioProcessorValueTreeState::SliderAttachment mPluginDryWetSliderAttachement,
-                                                         mPluginOutputLevelAttachement,
-                                                         mPluginOutputGainAttachement;
+                   mPluginOutputGain   {  "OUT::GAI"  },
+                   mPresetMorphSlider  {  "PRE::MRF"  };
+    CoalescedSliderAttachment mPluginDryWetSliderAttachement,
+                              mPluginOutputLevelAttachement,
+                              mPluginOutputGainAttachement,
+                              mPresetMorphSliderAttachement;
 
     PresetManagerComponent mPresetManager;
 
+    // Created right after the editor is shown, see createVisualizer().
+    std::unique_ptr<VisualizerComponent> mVisualizer;
+    juce::Rectangle<int> mVisualizerBounds;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginEditor)
 };
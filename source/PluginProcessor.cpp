@@ -1,7 +1,9 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Health/HealthCheck.hpp"
 #include "juce_core/juce_core.h"
 #include "juce_dsp/juce_dsp.h"
+#include <limits>
 
 //==============================================================================
 PluginProcessor::PluginProcessor()
@@ -9,25 +11,31 @@ PluginProcessor::PluginProcessor()
 #if !JucePlugin_IsMidiEffect
     #if !JucePlugin_IsSynth
                           .withInput ("Input", juce::AudioChannelSet::stereo(), true)
+                          .withInput ("Sidechain", juce::AudioChannelSet::stereo(), false)
     #endif
                           .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
 #endif
               ),
       delay (apvts),
+      midSide (apvts),
       ReverbDampingParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Reverb Damping"))),
       ReverbFreezeParameter (dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter ("Reverb Freeze"))),
       ReverbRoomSizeParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Reverb Room Size"))),
       ReverbWetParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Reverb Wet"))),
       ReverbDryParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Reverb Dry"))),
       ReverbWidthParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Reverb Width"))),
+      ducker (apvts),
       mOutputLevelParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Output Level"))),
       mOutputGainParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Output Gain"))),
-      mPluginDryWetParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Plugin Dry Wet")))
+      mPluginDryWetParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Plugin Dry Wet"))),
+      limiter (apvts),
+      mPresetMorphParameter (dynamic_cast<juce::AudioParameterFloat*> (apvts.getParameter ("Preset Morph")))
 {
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -105,24 +113,54 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumInputChannels();
+    spec.numChannels = static_cast<juce::uint32> (getMainBusNumInputChannels()); // not the sidechain
     spec.sampleRate = sampleRate;
 
+    // Hosts call prepareToPlay() again on any change of settings, even while playing:
+    // the delay and the reverb go on from where they were, unless we were released.
+    const auto startFromSilence = mStartFromSilence;
+    mStartFromSilence = false;
+
     delay.prepare(spec);
+    if (startFromSilence)
+        delay.reset();
+
+    // A thread per channel but the first, which the audio thread takes care of.
+    const auto numRenderWorkers = juce::jmin (getMainBusNumInputChannels(), juce::SystemStats::getNumCpus()) - 1;
+    if (mParallelRendering && isNonRealtime() && samplesPerBlock >= minParallelBlockSize && numRenderWorkers > 0)
+    {
+        if (mRenderThreadPool == nullptr || mRenderThreadPool->getNumWorkers() != numRenderWorkers)
+            mRenderThreadPool = std::make_unique<RenderThreadPool> (numRenderWorkers);
+    }
+    else
+    {
+        mRenderThreadPool.reset();
+    }
 
-    reverb.prepare (spec);
-    reverb.reset();
-    reverb.setEnabled (true);
+    // Preparing the reverb clears it, there's nothing to resample its tail from.
+    if (startFromSilence || sampleRate != mPreparedSampleRate || spec.numChannels != mPreparedNumChannels)
+    {
+        reverb.prepare (spec);
+        reverb.reset();
+        reverb.setEnabled (true);
+    }
+    mPreparedSampleRate = sampleRate;
+    mPreparedNumChannels = spec.numChannels;
+
+    ducker.prepare (spec);
+    mDuckerLatency = ducker.getLatencyInSamples();
 
-    dryWet.prepare (spec);
-    dryWet.setMixingRule (juce::dsp::DryWetMixingRule::linear);
-    dryWet.reset();
+    limiter.prepare (spec);
+    mLimiterLatency = limiter.getLatencyInSamples();
+    setLatencySamples (mDuckerLatency.load() + mLimiterLatency.load());
 
-    outputLevel.prepare(spec);
-    outputLevel.reset();
+    outputStage.setParameters (mPluginDryWetParameter->get(), mOutputLevelParameter->get(), mOutputGainParameter->get()); // reset() snaps to them
+    outputStage.prepare (spec, ducker.getMaxLatencyInSamples());
+    outputStage.setDryLatency (mDuckerLatency.load());
 
-    outputGain.prepare(spec);
-    outputGain.reset();
+    midSide.prepare (spec);
+
+    visualizerFifo.prepare (sampleRate);
 
     
 }
@@ -131,6 +169,8 @@ void PluginProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    // The buffers are kept for the next prepareToPlay(), which starts from silence.
+    mStartFromSilence = true;
 }
 
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -151,6 +191,14 @@ bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
         return false;
     #endif
 
+    // The sidechain is optional, mono or stereo.
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet (true, 1);
+        if (!sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
 #endif
 }
@@ -161,13 +209,19 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     juce::ignoreUnused (midiMessages);
 
     // Fetching the song's BPM has to be done within processBlock()
-    auto bpm = getPlayHead()->getPosition()->getBpm();
-    if (bpm.hasValue())
-        delay.setBPM (static_cast<int> (*bpm));
+    // There's no play head when rendering offline (e.g. preset auditions)
+    if (auto* playHead = getPlayHead())
+        if (auto position = playHead->getPosition())
+            if (auto bpm = position->getBpm())
+                delay.setBPM (static_cast<int> (*bpm));
 
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto totalNumInputChannels = getMainBusNumInputChannels();
+    auto totalNumOutputChannels = getMainBusNumOutputChannels();
+
+    // The sidechain's channels come after the main bus', everything
+    // but the ducker only works with the main bus.
+    auto mainBuffer = getBusBuffer (buffer, false, 0);
 
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
@@ -176,52 +230,109 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        mainBuffer.clear (i, 0, mainBuffer.getNumSamples());
+
+    // A NaN or an infinity coming in would stay in every state it goes through.
+    // Beyond that, the level of the input is the host's business.
+    if (!HealthCheck::isHealthy (juce::dsp::AudioBlock<float> (buffer), std::numeric_limits<float>::max()))
+    {
+        buffer.clear();
+        mNumStateResets.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    // Either the morphed values, or the ones from the APVTS.
+    PresetMorph::Values morphValues;
+    if (presetMorph.updateFromMessageThread())
+    {
+        morphValues = presetMorph.getValuesAt (mPresetMorphParameter->get());
+    }
+    else
+    {
+        morphValues.delay  = delay.dumpParametersFromAPVTS();
+        morphValues.reverb = dumpParametersFromAPVTS();
+        morphValues.ducker = ducker.dumpParametersFromAPVTS();
+        morphValues.midSide = midSide.dumpParametersFromAPVTS();
+        morphValues.dryWet = mPluginDryWetParameter->get();
+        morphValues.level  = mOutputLevelParameter->get();
+        morphValues.gain   = mOutputGainParameter->get();
+    }
+    ducker.setParameters (morphValues.ducker);
+
+    // The key has to be analysed before the delay overwrites the input.
+    auto* sidechainBus = getBus (true, 1);
+    if (ducker.wantsSidechain() && sidechainBus != nullptr && sidechainBus->isEnabled())
+        ducker.analyseKey (getBusBuffer (buffer, true, 1), mainBuffer.getNumSamples());
+    else
+        ducker.analyseKey (mainBuffer, mainBuffer.getNumSamples());
 
-    juce::dsp::AudioBlock<float> block (buffer);
+    // The lookahead was switched, the dry signal follows right away, the host a bit later.
+    if (ducker.getLatencyInSamples() != mDuckerLatency)
+    {
+        mDuckerLatency = ducker.getLatencyInSamples();
+        outputStage.setDryLatency (mDuckerLatency.load());
+        triggerAsyncUpdate();
+    }
+
+    juce::dsp::AudioBlock<float> block (mainBuffer);
     juce::dsp::ProcessContextReplacing<float> context(block);
 
+    delay.setParameters (morphValues.delay);
 
-    dryWet.pushDrySamples (block);
+    // Fully wet, the dry signal isn't copied.
+    outputStage.setParameters (morphValues.dryWet, morphValues.level, morphValues.gain);
+    outputStage.captureDry (block);
 
-    const auto bufferLength = buffer.getNumSamples();
-    const auto delayBufferLength = delay.getDelayBuffer().getNumSamples();
+    // Below that, waking the workers costs more than it saves. Realtime, they'd compete with the host's own threads.
+    const auto parallel = mRenderThreadPool != nullptr && isNonRealtime() && mainBuffer.getNumSamples() >= minParallelBlockSize;
+    delay.setThreadPool (parallel ? mRenderThreadPool.get() : nullptr);
 
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    const auto blockWritePosition = delay.mWritePosition;
+    delay.process (context);
+
+    // The feedback loops are checked once per block, only the one that went bad starts
+    // over. This block of the wet signal is lost either way, it's silenced.
+    if (delay.resetIfUnhealthy())
     {
-        const auto* bufferData = buffer.getReadPointer (channel);
-        auto dryBuffer = buffer.getWritePointer (channel);
-        // read the values from buffer and store them in delayBuffer.
-        delay.fillDelayBuffer (channel, bufferLength, bufferData);
-        // read the values from the delayBuffer and write them to the audio buffer.
-        delay.getFromDelayBuffer (buffer, channel, bufferLength);
-        // apply feedback
-        delay.feedbackDelay (channel, bufferLength, dryBuffer);
+        block.clear();
+        mNumStateResets.fetch_add (1, std::memory_order_relaxed);
     }
-    /* We read bufferLength values so we need to increment the write position
-     * so that, next time, we read once again bufferLength values but don't 
-     * overwrite the previously saved values.
-     */
-    delay.mWritePosition += bufferLength;
-    delay.mWritePosition %= delayBufferLength; // wrap around
-
-    // delay.process(context);
 
-    reverb.setParameters (dumpParametersFromAPVTS());
+    reverb.setParameters (morphValues.reverb);
     reverb.process (context);
 
-    /*  
-        // TODO: Use process function
-        delay.process(context); 
-    */
-    dryWet.mixWetSamples (block);
-    dryWet.setWetMixProportion (mPluginDryWetParameter->get());
+    if (!HealthCheck::isHealthy (block))
+    {
+        reverb.reset();
+        block.clear();
+        mNumStateResets.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    ducker.process (context);
+
+    // Level and gain go with the mix, before the mid/side stage: it's linear, that's the same but for rounding.
+    outputStage.process (context);
 
-    outputLevel.setGainLinear(mOutputLevelParameter->get());
-    outputLevel.process(context);
+    midSide.setParameters (morphValues.midSide);
+    midSide.process (context);
+
+    // Whatever the gain and the feedback, the output doesn't clip.
+    limiter.process (context);
+    if (limiter.getLatencyInSamples() != mLimiterLatency)
+    {
+        mLimiterLatency = limiter.getLatencyInSamples();
+        triggerAsyncUpdate();
+    }
 
-    outputGain.setGainLinear(mOutputGainParameter->get());
-    outputGain.process(context);
+    // While the browser auditions a preset, it's heard instead of our output.
+    auditionPlayer.process (mainBuffer);
+
+    // Does nothing unless an editor is open.
+    visualizerFifo.push (mainBuffer, delay.getDelayBuffer(), blockWritePosition, delay.getDelayInSamples());
+}
+
+void PluginProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (mDuckerLatency.load() + mLimiterLatency.load());
 }
 
 //==============================================================================
@@ -241,10 +352,13 @@ void PluginProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     /*
      * Write the state of the APVTS to a memory output stream.
-     * i.e. Serialize the APVTS' state.
+     * i.e. Serialize the APVTS' state, with the morph slots in it.
      * */
+    auto state = apvts.copyState();
+    state.appendChild (presetMorph.getState(), nullptr);
+
     juce::MemoryOutputStream outputStream (destData, true);
-    apvts.state.writeToStream (outputStream);
+    state.writeToStream (outputStream);
 }
 
 void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -252,6 +366,16 @@ void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
     auto tree = juce::ValueTree::readFromData (data, sizeInBytes);
     if (tree.isValid())
     {
+        // The morph slots aren't parameters, they stay out of the APVTS.
+        // Older sessions have none, the slots are emptied.
+        const auto morphState = tree.getChildWithName (PresetMorph::stateType);
+        tree.removeChild (morphState, nullptr);
+        presetMorph.setState (morphState);
+
+        // Sessions saved before the OpenGL switch don't have it, keep ours.
+        if (!tree.hasProperty (useOpenGLProperty))
+            tree.setProperty (useOpenGLProperty, apvts.state.getProperty (useOpenGLProperty, false), nullptr);
+
         apvts.replaceState (tree);
     }
 }
@@ -263,6 +387,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::CreateParam
     // Delay Parameters
     delay.AppendToParameterLayout (layout);
 
+    // Mid/Side Parameters
+    midSide.AppendToParameterLayout (layout);
+
+    // Ducking Parameters
+    ducker.AppendToParameterLayout (layout);
+
+    // Limiter Parameters
+    limiter.AppendToParameterLayout (layout);
+
     // Reverb Parameters
     layout.add (std::make_unique<juce::AudioParameterFloat> ("Reverb Damping", "Reverb Damping", juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f, 1.f), 0.1f));
 
@@ -283,6 +416,9 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::CreateParam
     
     layout.add (std::make_unique<juce::AudioParameterFloat> ("Output Gain", "Output Gain", juce::NormalisableRange<float> (1.0f, 1.5f, 0.01f), 1.0f));
 
+    // No step so that the morph can be automated smoothly
+    layout.add (std::make_unique<juce::AudioParameterFloat> ("Preset Morph", "Preset Morph", juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f));
+
     return layout;
 }
 
@@ -1,15 +1,26 @@
 #pragma once
 
 #include "Delay/Delay.hpp"
+#include "Ducker/Ducker.hpp"
+#include "MidSide/MidSide.hpp"
+#include "OutputStage/OutputStage.hpp"
+#include "OutputStage/TruePeakLimiter.hpp"
+#include "Parallel/RenderThreadPool.hpp"
+#include "Preset/PresetMorph.hpp"
+#include "Preset/PresetAudition.hpp"
+#include "Visualizer/VisualizerFifo.hpp"
 #include "juce_audio_basics/juce_audio_basics.h"
 #include "juce_dsp/juce_dsp.h"
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include <memory>
 
 #if (MSVC)
     #include "ipps.h"
 #endif
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private juce::AsyncUpdater
 {
 public:
     PluginProcessor();
@@ -41,7 +52,28 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Whether the editor renders with OpenGL, a property of the APVTS' state.
+    static inline const juce::Identifier useOpenGLProperty { "UseOpenGL" };
+
     juce::AudioProcessorValueTreeState& getApvts() { return apvts; }
+    PresetMorph& getPresetMorph() { return presetMorph; }
+    PresetAuditionPlayer& getAuditionPlayer() { return auditionPlayer; }
+    VisualizerFifo& getVisualizerFifo() { return visualizerFifo; }
+
+    /**
+     * @brief Offline renders with blocks of at least minParallelBlockSize
+     *        process the delay's channels on several threads. On by default,
+     *        takes effect at the next prepareToPlay().
+     */
+    void setParallelRendering (bool shouldBeEnabled) { mParallelRendering = shouldBeEnabled; }
+
+    /**
+     * @brief How many times a NaN, an infinity or a runaway level was caught, in
+     *        the input, the delay or the reverb, and the state it was in cleared.
+     */
+    int getNumStateResets() const { return mNumStateResets.load (std::memory_order_relaxed); }
+
+    static constexpr int minParallelBlockSize = 8192;
 private:
     /*======================== FUNCTIONS ===========================*/
     /**
@@ -61,10 +93,18 @@ private:
      */
     juce::dsp::Reverb::Parameters dumpParametersFromAPVTS();
 
+    /**
+     * @brief Reports the ducker's and the limiter's latency to the host, on the message thread.
+     */
+    void handleAsyncUpdate() override;
+
     /*======================== MEMBERS ===========================*/
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", CreateParameterLayout() };
     
     Delay delay;
+
+    // Stereo width and mid/side, after the output stage
+    MidSide midSide;
     
     // Reverb from juce::dsp and related parameters
     juce::dsp::Reverb reverb;
@@ -75,13 +115,44 @@ private:
     juce::AudioParameterFloat* ReverbDryParameter = nullptr;
     juce::AudioParameterFloat* ReverbWidthParameter = nullptr;
 
-    // juce::dsp drywet mixer and related audio parameter
-    juce::dsp::DryWetMixer<float> dryWet;
-    juce::dsp::Gain<float> outputLevel;
-    juce::dsp::Gain<float> outputGain;
+    // Ducks the wet signal from the input or the sidechain, before the dry/wet mix
+    Ducker ducker;
+    std::atomic<int> mDuckerLatency { 0 }; // the dry signal is delayed as much, read by handleAsyncUpdate()
+
+    // Dry/wet mix, output level and output gain, in one pass
+    OutputStage outputStage;
     juce::AudioParameterFloat* mPluginDryWetParameter = nullptr;    
     juce::AudioParameterFloat* mOutputLevelParameter = nullptr;    
     juce::AudioParameterFloat* mOutputGainParameter = nullptr;    
 
+    // True-peak limiter, the last stage before the output
+    TruePeakLimiter limiter;
+    std::atomic<int> mLimiterLatency { 0 }; // reported along with the ducker's, by handleAsyncUpdate()
+
+    // A/B preset morph, overrides the APVTS values while active
+    PresetMorph presetMorph;
+    juce::AudioParameterFloat* mPresetMorphParameter = nullptr;
+
+    // Plays a preset's audition instead of our output, see PresetAuditionCache
+    PresetAuditionPlayer auditionPlayer;
+
+    // Levels and delay buffer for the editor's visualizer
+    VisualizerFifo visualizerFifo;
+
+    // Only exists while rendering offline with long enough blocks, see setParallelRendering()
+    std::unique_ptr<RenderThreadPool> mRenderThreadPool;
+    std::atomic<bool> mParallelRendering { true };
+
+    // See getNumStateResets()
+    std::atomic<int> mNumStateResets { 0 };
+
+    // What the last prepareToPlay() was given, and whether the next one clears every state.
+    double mPreparedSampleRate = 0.0;
+    juce::uint32 mPreparedNumChannels = 0;
+    bool mStartFromSilence = true;
+
+    // Defined in the tests, puts a fault inside the delay's and the reverb's feedback loops.
+    friend struct StateRecoveryTestAccess;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
 };
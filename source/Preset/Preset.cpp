@@ -0,0 +1,212 @@
+#include "Preset.hpp"
+#include "juce_core/juce_core.h"
+
+Preset Preset::fromXml (const juce::XmlElement& element)
+{
+    Preset preset;
+
+    if (!element.hasTagName ("PRESET"))
+        return preset;
+
+    /*
+    * There, the goal is to fetch every data from every node.
+    * Our nodes are:
+    *  - INFORMATION
+    *  - PARAMETERS
+    *      - DELAY
+    *      - REVERB
+    *      - PLUGIN
+    *      - MODULATION
+    *      - GRAINS
+    *      - SHIMMER
+    *      - DUCKER
+    *      - MIDSIDE
+    */
+    for (auto* e : element.getChildIterator())
+    {
+        if (e->hasTagName ("INFORMATION"))
+        {
+            preset.presetName = e->getStringAttribute ("Name");
+            preset.authorName = e->getStringAttribute ("Author");
+            preset.category   = e->getStringAttribute ("Category");
+        }
+        else if (e->hasTagName ("PARAMETERS"))
+        {
+            for (auto* child : e->getChildIterator())
+            {
+                if (child->hasTagName ("DELAY"))
+                {
+                    preset.delayTime            = child->getIntAttribute ("Time");
+                    preset.delayFeedback        = (float) child->getDoubleAttribute ("Feedback");
+                    preset.delaySyncToggleState = child->getBoolAttribute ("SyncToggle");
+                    preset.delaySyncDivider     = child->getIntAttribute ("SyncDivider");
+                }
+                else if (child->hasTagName ("REVERB"))
+                {
+                    preset.reverbDamping        = (float) child->getDoubleAttribute ("Damping");
+                    preset.reverbFreezeState    = child->getBoolAttribute ("Freeze");
+                    preset.reverbRoomSize       = (float) child->getDoubleAttribute ("RoomSize");
+                    preset.reverbWet            = (float) child->getDoubleAttribute ("Wet");
+                    preset.reverbDry            = (float) child->getDoubleAttribute ("Dry");
+                    preset.reverbWidth          = (float) child->getDoubleAttribute ("Width");
+                }
+                else if (child->hasTagName ("PLUGIN"))
+                {
+                    preset.pluginDryWet         = (float) child->getDoubleAttribute ("DryWet");
+                    preset.pluginLevel          = (float) child->getDoubleAttribute ("Level");
+                    preset.pluginGain           = (float) child->getDoubleAttribute ("Gain");
+                }
+                else if (child->hasTagName ("MODULATION"))
+                {
+                    preset.delayModRate         = (float) child->getDoubleAttribute ("Rate", preset.delayModRate);
+                    preset.delayModDepth        = (float) child->getDoubleAttribute ("Depth", preset.delayModDepth);
+                    preset.delayModShape        = child->getIntAttribute ("Shape", preset.delayModShape);
+                    preset.delayModStereo       = (float) child->getDoubleAttribute ("Stereo", preset.delayModStereo);
+                }
+                else if (child->hasTagName ("GRAINS"))
+                {
+                    preset.delayMode                = child->getIntAttribute ("Mode", preset.delayMode);
+                    preset.delayGrainSize           = (float) child->getDoubleAttribute ("Size", preset.delayGrainSize);
+                    preset.delayGrainDensity        = child->getIntAttribute ("Density", preset.delayGrainDensity);
+                    preset.delayGrainPitchJitter    = (float) child->getDoubleAttribute ("PitchJitter", preset.delayGrainPitchJitter);
+                    preset.delayGrainPositionJitter = (float) child->getDoubleAttribute ("PositionJitter", preset.delayGrainPositionJitter);
+                }
+                else if (child->hasTagName ("SHIMMER"))
+                {
+                    preset.delayShimmer         = (float) child->getDoubleAttribute ("Amount", preset.delayShimmer);
+                    preset.delayShimmerPitch    = child->getIntAttribute ("Pitch", preset.delayShimmerPitch);
+                }
+                else if (child->hasTagName ("DUCKER"))
+                {
+                    preset.duckDepth            = (float) child->getDoubleAttribute ("Depth", preset.duckDepth);
+                    preset.duckThreshold        = (float) child->getDoubleAttribute ("Threshold", preset.duckThreshold);
+                    preset.duckAttack           = (float) child->getDoubleAttribute ("Attack", preset.duckAttack);
+                    preset.duckRelease          = (float) child->getDoubleAttribute ("Release", preset.duckRelease);
+                    preset.duckLookahead        = child->getBoolAttribute ("Lookahead", preset.duckLookahead);
+                    preset.duckSource           = child->getIntAttribute ("Source", preset.duckSource);
+                }
+                else if (child->hasTagName ("MIDSIDE"))
+                {
+                    preset.stereoWidth          = (float) child->getDoubleAttribute ("Width", preset.stereoWidth);
+                    preset.midGain              = (float) child->getDoubleAttribute ("MidGain", preset.midGain);
+                    preset.sideGain             = (float) child->getDoubleAttribute ("SideGain", preset.sideGain);
+                    preset.bassMonoFrequency    = (float) child->getDoubleAttribute ("BassMono", preset.bassMonoFrequency);
+                }
+            }
+        }
+    }
+    return preset;
+}
+
+std::unique_ptr<juce::XmlElement> Preset::toXml() const
+{
+    auto motherNode = std::make_unique<juce::XmlElement> ("PRESET");
+    auto* infoChild = motherNode->createNewChildElement ("INFORMATION");
+
+    infoChild->setAttribute ("Name",     presetName);
+    infoChild->setAttribute ("Author",   authorName);
+    infoChild->setAttribute ("Category", category);
+
+    auto* parameterChild   = motherNode->createNewChildElement ("PARAMETERS");
+    auto* delayGrandChild  = parameterChild->createNewChildElement ("DELAY");
+    auto* reverbGrandChild = parameterChild->createNewChildElement ("REVERB");
+    auto* pluginGrandChild = parameterChild->createNewChildElement ("PLUGIN");
+    auto* modGrandChild    = parameterChild->createNewChildElement ("MODULATION");
+    auto* grainsGrandChild = parameterChild->createNewChildElement ("GRAINS");
+    auto* shimmerGrandChild = parameterChild->createNewChildElement ("SHIMMER");
+    auto* duckerGrandChild = parameterChild->createNewChildElement ("DUCKER");
+    auto* midSideGrandChild = parameterChild->createNewChildElement ("MIDSIDE");
+
+    delayGrandChild->setAttribute ("Time",        delayTime);
+    delayGrandChild->setAttribute ("Feedback",    delayFeedback);
+    delayGrandChild->setAttribute ("SyncToggle",  delaySyncToggleState ? "true" : "false");
+    delayGrandChild->setAttribute ("SyncDivider", delaySyncDivider);
+
+    reverbGrandChild->setAttribute ("Damping",    reverbDamping);
+    reverbGrandChild->setAttribute ("Freeze",     reverbFreezeState ? "true" : "false");
+    reverbGrandChild->setAttribute ("RoomSize",   reverbRoomSize);
+    reverbGrandChild->setAttribute ("Wet",        reverbWet);
+    reverbGrandChild->setAttribute ("Dry",        reverbDry);
+    reverbGrandChild->setAttribute ("Width",      reverbWidth);
+
+    pluginGrandChild->setAttribute ("DryWet",     pluginDryWet);
+    pluginGrandChild->setAttribute ("Level",      pluginLevel);
+    pluginGrandChild->setAttribute ("Gain",       pluginGain);
+
+    modGrandChild->setAttribute ("Rate",          delayModRate);
+    modGrandChild->setAttribute ("Depth",         delayModDepth);
+    modGrandChild->setAttribute ("Shape",         delayModShape);
+    modGrandChild->setAttribute ("Stereo",        delayModStereo);
+
+    grainsGrandChild->setAttribute ("Mode",           delayMode);
+    grainsGrandChild->setAttribute ("Size",           delayGrainSize);
+    grainsGrandChild->setAttribute ("Density",        delayGrainDensity);
+    grainsGrandChild->setAttribute ("PitchJitter",    delayGrainPitchJitter);
+    grainsGrandChild->setAttribute ("PositionJitter", delayGrainPositionJitter);
+
+    shimmerGrandChild->setAttribute ("Amount",       delayShimmer);
+    shimmerGrandChild->setAttribute ("Pitch",        delayShimmerPitch);
+
+    duckerGrandChild->setAttribute ("Depth",         duckDepth);
+    duckerGrandChild->setAttribute ("Threshold",     duckThreshold);
+    duckerGrandChild->setAttribute ("Attack",        duckAttack);
+    duckerGrandChild->setAttribute ("Release",       duckRelease);
+    duckerGrandChild->setAttribute ("Lookahead",     duckLookahead ? "true" : "false");
+    duckerGrandChild->setAttribute ("Source",        duckSource);
+
+    midSideGrandChild->setAttribute ("Width",        stereoWidth);
+    midSideGrandChild->setAttribute ("MidGain",      midGain);
+    midSideGrandChild->setAttribute ("SideGain",     sideGain);
+    midSideGrandChild->setAttribute ("BassMono",     bassMonoFrequency);
+
+    return motherNode;
+}
+
+std::vector<std::pair<juce::String, float>> Preset::getParameterValues() const
+{
+    return {
+        { "Delay Feedback",              delayFeedback },
+        { "Delay Sync",                  (float) delaySyncDivider },
+        { "Delay Sync Toggle",           delaySyncToggleState ? 1.0f : 0.0f },
+        { "Delay Time",                  (float) delayTime },
+        { "Output Level",                pluginLevel },
+        { "Plugin Dry Wet",              pluginDryWet },
+        { "Output Gain",                 pluginGain },
+        { "Reverb Damping",              reverbDamping },
+        { "Reverb Dry",                  reverbDry },
+        { "Reverb Freeze",               reverbFreezeState ? 1.0f : 0.0f },
+        { "Reverb Room Size",            reverbRoomSize },
+        { "Reverb Wet",                  reverbWet },
+        { "Reverb Width",                reverbWidth },
+        { "Delay Mod Rate",              delayModRate },
+        { "Delay Mod Depth",             delayModDepth },
+        { "Delay Mod Shape",             (float) delayModShape },
+        { "Delay Mod Stereo",            delayModStereo },
+        { "Delay Mode",                  (float) delayMode },
+        { "Delay Grain Size",            delayGrainSize },
+        { "Delay Grain Density",         (float) delayGrainDensity },
+        { "Delay Grain Pitch Jitter",    delayGrainPitchJitter },
+        { "Delay Grain Position Jitter", delayGrainPositionJitter },
+        { "Delay Shimmer",               delayShimmer },
+        { "Delay Shimmer Pitch",         (float) delayShimmerPitch },
+        { "Duck Depth",                  duckDepth },
+        { "Duck Threshold",              duckThreshold },
+        { "Duck Attack",                 duckAttack },
+        { "Duck Release",                duckRelease },
+        { "Duck Lookahead",              duckLookahead ? 1.0f : 0.0f },
+        { "Duck Source",                 (float) duckSource },
+        { "Stereo Width",                stereoWidth },
+        { "Mid Gain",                    midGain },
+        { "Side Gain",                   sideGain },
+        { "Bass Mono Frequency",         bassMonoFrequency },
+    };
+}
+
+void Preset::applyTo (juce::AudioProcessorValueTreeState& apvts) const
+{
+    for (const auto& [parameterID, value] : getParameterValues())
+    {
+        if (auto* parameter = apvts.getParameter (parameterID))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+}
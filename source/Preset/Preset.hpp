@@ -0,0 +1,128 @@
+#pragma once
+
+#include "juce_core/juce_core.h"
+#include "juce_data_structures/juce_data_structures.h"
+#include "juce_audio_processors/juce_audio_processors.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief a simple struct to contain every parameter and
+ *        values of a preset dumped from an XML file.
+ *
+ *        The delay freeze isn't part of a preset: it's played live,
+ *        over whatever is in the delay, and loading a preset leaves it
+ *        as it is. Neither is the limiter, it protects the monitoring
+ *        whatever the preset.
+ */
+struct Preset
+{
+    // PRESET INFO
+    juce::String presetName    = {};
+    juce::String authorName    = {};
+    juce::String category      = {};
+
+    // PARAMETERS VALUES
+    //    DELAY
+    int   delayTime            = 0;
+    float delayFeedback        = 0.0f;
+    bool  delaySyncToggleState = false;
+    int   delaySyncDivider     = 1;
+
+    //    REVERB
+    float reverbDamping        = 0.0f;
+    bool  reverbFreezeState    = false;
+    float reverbRoomSize       = 0.0f;
+    float reverbWet            = 0.0f;
+    float reverbDry            = 0.0f;
+    float reverbWidth          = 0.0f;
+
+    //    PLUGIN
+    float pluginDryWet         = 0.0f;
+    float pluginLevel          = 0.0f;
+    float pluginGain           = 0.0f;
+
+    // Nodes added after the first presets were made: their defaults are
+    // the parameters' ones, a preset without them loads as it was saved.
+    //    MODULATION
+    float delayModRate         = 0.5f;
+    float delayModDepth        = 0.0f;
+    int   delayModShape        = 0;
+    float delayModStereo       = 90.0f;
+
+    //    GRAINS
+    int   delayMode            = 0;
+    float delayGrainSize       = 100.0f;
+    int   delayGrainDensity    = 4;
+    float delayGrainPitchJitter    = 0.0f;
+    float delayGrainPositionJitter = 0.0f;
+
+    //    SHIMMER
+    float delayShimmer         = 0.0f;
+    int   delayShimmerPitch    = 0;
+
+    //    DUCKER
+    float duckDepth            = 0.0f;
+    float duckThreshold        = -30.0f;
+    float duckAttack           = 5.0f;
+    float duckRelease          = 250.0f;
+    bool  duckLookahead        = false;
+    int   duckSource           = 0;
+
+    //    MIDSIDE
+    float stereoWidth          = 1.0f;
+    float midGain              = 1.0f;
+    float sideGain             = 1.0f;
+    float bassMonoFrequency    = 20.0f;
+
+    /* ========= METHODS ========== */
+
+    /**
+     * @brief Builds a Preset out of a <PRESET> xml element.
+     *        Missing nodes leave their values to the defaults above.
+     *
+     * @param element the <PRESET> node.
+     * @return Preset
+     */
+    static Preset fromXml (const juce::XmlElement& element);
+
+    /**
+     * @brief Serializes this preset to a <PRESET> xml element,
+     *        following the same layout as the files in Resources/.
+     *
+     * @return std::unique_ptr<juce::XmlElement>
+     */
+    std::unique_ptr<juce::XmlElement> toXml() const;
+
+    /**
+     * @brief The plain value of every parameter stored in a preset,
+     *        by parameter ID.
+     *
+     * @return std::vector<std::pair<juce::String, float>>
+     */
+    std::vector<std::pair<juce::String, float>> getParameterValues() const;
+
+    /**
+     * @brief Sets the parameters stored in a preset, one by one, like
+     *        a host would. The others are left as they are, and unlike
+     *        replaceState() the value tree isn't touched, so it's safe
+     *        off the message thread.
+     *
+     * @param apvts the parameters to set.
+     */
+    void applyTo (juce::AudioProcessorValueTreeState& apvts) const;
+
+    #if DEBUG
+    void print()
+    {
+        // DBG PURPOSES ONLY
+        DBG("presetName:");        DBG(presetName);
+        DBG("authorName:");        DBG(authorName);
+        DBG("category:");          DBG(category);
+        DBG("delayTime:");         DBG(delayTime);
+        DBG("reverbDamping:");     DBG(reverbDamping);
+        DBG("pluginDryWet:");      DBG(pluginDryWet);
+    }
+    #endif
+};
@@ -0,0 +1,240 @@
+#include "PresetAudition.hpp"
+#include "../PluginProcessor.h"
+#include "Preset.hpp"
+#include "juce_audio_formats/juce_audio_formats.h"
+
+std::unique_ptr<juce::AudioBuffer<float>> PresetAuditionClip::decode() const
+{
+    juce::FlacAudioFormat flac;
+    std::unique_ptr<juce::AudioFormatReader> reader (flac.createReaderFor (new juce::MemoryInputStream (compressedAudio, false), true));
+
+    if (reader == nullptr)
+        return nullptr;
+
+    auto buffer = std::make_unique<juce::AudioBuffer<float>> (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+    reader->read (buffer.get(), 0, buffer->getNumSamples(), 0, true, true);
+
+    return buffer;
+}
+
+//==============================================================================
+PresetAuditionCache::PresetAuditionCache() : juce::Thread ("Preset auditions")
+{
+}
+
+PresetAuditionCache::~PresetAuditionCache()
+{
+    stopThread (4000);
+}
+
+void PresetAuditionCache::setSampleRate (double newSampleRate)
+{
+    const juce::ScopedLock lock (mLock);
+    mSampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+}
+
+juce::int64 PresetAuditionCache::makeKey (juce::int64 contentHash) const
+{
+    return contentHash ^ (static_cast<juce::int64> (mSampleRate) * 0x9E3779B97F4A7C15LL);
+}
+
+std::shared_ptr<const PresetAuditionClip> PresetAuditionCache::getClip (juce::int64 contentHash) const
+{
+    const juce::ScopedLock lock (mLock);
+
+    auto clip = mClips.find (makeKey (contentHash));
+    return clip != mClips.end() ? clip->second : nullptr;
+}
+
+void PresetAuditionCache::requestClip (juce::int64 contentHash, const juce::File& presetFile)
+{
+    // Created here rather than on the worker: the processor owns timers
+    // that should be created and destroyed on the message thread.
+    if (mRenderer == nullptr)
+        mRenderer = std::make_unique<PluginProcessor>();
+
+    {
+        const juce::ScopedLock lock (mLock);
+
+        const auto key = makeKey (contentHash);
+        if (mClips.count (key) != 0)
+            return;
+
+        for (const auto& request : mRequests)
+            if (request.key == key)
+                return;
+
+        // Only the rows that were shown recently matter, forget the oldest requests.
+        if (mRequests.size() >= 64)
+            mRequests.pop_front();
+
+        mRequests.push_back ({ key, presetFile, mSampleRate });
+    }
+
+    if (!isThreadRunning())
+        startThread (juce::Thread::Priority::background);
+
+    notify();
+}
+
+void PresetAuditionCache::run()
+{
+    while (!threadShouldExit())
+    {
+        Request request;
+        bool hasRequest = false;
+        {
+            const juce::ScopedLock lock (mLock);
+            if (!mRequests.empty())
+            {
+                request = mRequests.back(); // latest first, it's most likely on screen
+                mRequests.pop_back();
+                hasRequest = true;
+            }
+        }
+
+        if (!hasRequest)
+        {
+            wait (-1);
+            continue;
+        }
+
+        if (auto clip = render (request))
+        {
+            {
+                const juce::ScopedLock lock (mLock);
+                mClips[request.key] = std::move (clip);
+                mClipsAge.push_back (request.key);
+
+                while (mClipsAge.size() > maxNumClips)
+                {
+                    mClips.erase (mClipsAge.front());
+                    mClipsAge.pop_front();
+                }
+            }
+
+            sendChangeMessage();
+        }
+    }
+}
+
+std::shared_ptr<const PresetAuditionClip> PresetAuditionCache::render (const Request& request)
+{
+    auto element = juce::XmlDocument::parse (request.presetFile);
+    if (element == nullptr || !element->hasTagName ("PRESET"))
+        return nullptr;
+
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    const auto numSamples = static_cast<int> (clipLengthSeconds * request.sampleRate);
+
+    // prepareToPlay() after releaseResources() resets every state, so each render
+    // starts from silence, even after one that was given up halfway.
+    // The parameters are set like a host would: the renderer's value tree
+    // belongs to the message thread, where its timer flushes them into it.
+    Preset::fromXml (*element).applyTo (mRenderer->getApvts());
+    mRenderer->releaseResources();
+    mRenderer->setRateAndBufferSizeDetails (request.sampleRate, blockSize);
+    mRenderer->prepareToPlay (request.sampleRate, blockSize);
+
+    juce::AudioBuffer<float> audio (numChannels, numSamples);
+    fillReferenceSignal (audio, request.sampleRate);
+
+    juce::MidiBuffer midi;
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        if (threadShouldExit())
+            return nullptr;
+
+        juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), numChannels, start, juce::jmin (blockSize, numSamples - start));
+        mRenderer->processBlock (block, midi);
+    }
+
+    mRenderer->releaseResources();
+
+    auto clip = std::make_shared<PresetAuditionClip>();
+    clip->sampleRate = request.sampleRate;
+
+    // Waveform: min and max over every channel for each point.
+    clip->thumbnail.reserve (2 * PresetAuditionClip::numThumbnailPoints);
+    const auto samplesPerPoint = numSamples / PresetAuditionClip::numThumbnailPoints;
+    for (int point = 0; point < PresetAuditionClip::numThumbnailPoints; ++point)
+    {
+        auto range = audio.findMinMax (0, point * samplesPerPoint, samplesPerPoint);
+        for (int channel = 1; channel < numChannels; ++channel)
+            range = range.getUnionWith (audio.findMinMax (channel, point * samplesPerPoint, samplesPerPoint));
+
+        clip->thumbnail.push_back (range.getStart());
+        clip->thumbnail.push_back (range.getEnd());
+    }
+
+    juce::FlacAudioFormat flac;
+    auto* stream = new juce::MemoryOutputStream (clip->compressedAudio, false);
+    std::unique_ptr<juce::AudioFormatWriter> writer (flac.createWriterFor (stream, request.sampleRate, numChannels, 24, {}, 0));
+
+    if (writer == nullptr)
+    {
+        delete stream;
+        return nullptr;
+    }
+
+    writer->writeFromAudioSampleBuffer (audio, 0, numSamples);
+    writer.reset(); // flushes into clip->compressedAudio
+
+    return clip;
+}
+
+void PresetAuditionCache::fillReferenceSignal (juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    buffer.clear();
+
+    juce::Random random (1234); // same pluck for every preset
+    const auto pluckLength = juce::jmin (buffer.getNumSamples(), static_cast<int> (0.15 * sampleRate));
+    const auto decay = std::exp (-6.0f / static_cast<float> (pluckLength));
+    const auto phaseIncrement = juce::MathConstants<float>::twoPi * 220.0f / static_cast<float> (sampleRate);
+
+    auto* left = buffer.getWritePointer (0);
+    auto envelope = 0.7f;
+    for (int i = 0; i < pluckLength; ++i)
+    {
+        left[i] = envelope * (0.5f * std::sin (phaseIncrement * static_cast<float> (i)) + 0.5f * (2.0f * random.nextFloat() - 1.0f));
+        envelope *= decay;
+    }
+
+    for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+        buffer.copyFrom (channel, 0, buffer, 0, 0, pluckLength);
+}
+
+//==============================================================================
+void PresetAuditionPlayer::play (std::unique_ptr<juce::AudioBuffer<float>> clip)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock (mLock);
+        std::swap (mClip, clip);
+        mPosition = 0;
+    }
+    // the previous clip is freed here, on the message thread.
+}
+
+bool PresetAuditionPlayer::process (juce::AudioBuffer<float>& buffer)
+{
+    const juce::SpinLock::ScopedTryLockType lock (mLock);
+
+    if (!lock.isLocked() || mClip == nullptr || mClip->getNumChannels() == 0)
+        return false;
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto numToCopy = juce::jmin (numSamples, mClip->getNumSamples() - mPosition);
+    if (numToCopy <= 0)
+        return false;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        buffer.copyFrom (channel, 0, *mClip, juce::jmin (channel, mClip->getNumChannels() - 1), mPosition, numToCopy);
+        if (numToCopy < numSamples)
+            buffer.clear (channel, numToCopy, numSamples - numToCopy);
+    }
+
+    mPosition += numToCopy;
+    return true;
+}
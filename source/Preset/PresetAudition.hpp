@@ -0,0 +1,133 @@
+#pragma once
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+#include "juce_events/juce_events.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+class PluginProcessor;
+
+/**
+ * @brief A short render of a preset: the reference signal
+ *        through the plugin, FLAC compressed, and its waveform.
+ */
+struct PresetAuditionClip
+{
+    static constexpr int numThumbnailPoints = 64;
+
+    juce::MemoryBlock compressedAudio;      // FLAC
+    std::vector<float> thumbnail;           // min/max pairs, numThumbnailPoints of them
+    double sampleRate = 44100.0;
+
+    /**
+     * @brief Decodes the clip. Fast enough to be done on click.
+     */
+    std::unique_ptr<juce::AudioBuffer<float>> decode() const;
+};
+
+/**
+ * @brief Renders and keeps the auditions of the presets.
+ *
+ *        Renders happen on a worker thread, through a private
+ *        PluginProcessor that belongs to the cache, so the live
+ *        instance is never reconfigured. Clips are keyed by the hash
+ *        of the preset file's content and the sample rate.
+ *        A change message is sent every time a clip is ready.
+ */
+class PresetAuditionCache : public juce::ChangeBroadcaster,
+                            private juce::Thread
+{
+public:
+    static constexpr double clipLengthSeconds = 2.5;
+    static constexpr size_t maxNumClips = 512;
+
+    PresetAuditionCache();
+    ~PresetAuditionCache() override;
+
+    /**
+     * @brief The sample rate new clips are rendered at,
+     *        should be the one of the live instance.
+     */
+    void setSampleRate (double newSampleRate);
+
+    /**
+     * @brief Returns the clip of the preset whose content hash is
+     *        contentHash, or nullptr if it hasn't been rendered yet.
+     */
+    std::shared_ptr<const PresetAuditionClip> getClip (juce::int64 contentHash) const;
+
+    /**
+     * @brief Asks for presetFile to be rendered, unless it's
+     *        already cached or queued. Message thread only.
+     */
+    void requestClip (juce::int64 contentHash, const juce::File& presetFile);
+
+private:
+    struct Request
+    {
+        juce::int64 key = 0;
+        juce::File presetFile;
+        double sampleRate = 44100.0;
+    };
+
+    void run() override;
+
+    juce::int64 makeKey (juce::int64 contentHash) const;
+    std::shared_ptr<const PresetAuditionClip> render (const Request& request);
+
+    /**
+     * @brief The signal every preset is auditioned with: a short pluck
+     *        (a decaying noise burst and tone) followed by silence,
+     *        so the echoes and the tail are heard.
+     */
+    static void fillReferenceSignal (juce::AudioBuffer<float>& buffer, double sampleRate);
+
+    std::unique_ptr<PluginProcessor> mRenderer; // processed on the worker thread only, its value tree stays with the message thread
+
+    juce::CriticalSection mLock;
+    std::map<juce::int64, std::shared_ptr<const PresetAuditionClip>> mClips; // under mLock
+    std::deque<juce::int64> mClipsAge;                                       // under mLock, oldest first
+    std::deque<Request> mRequests;                                           // under mLock
+    double mSampleRate = 44100.0;                                            // under mLock
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetAuditionCache)
+};
+
+/**
+ * @brief Plays a decoded audition instead of the plugin's output,
+ *        from within processBlock.
+ */
+class PresetAuditionPlayer
+{
+public:
+    PresetAuditionPlayer() = default;
+
+    /**
+     * @brief Starts playing clip from its beginning. Message thread only.
+     *        The previous clip is freed here, never on the audio thread.
+     */
+    void play (std::unique_ptr<juce::AudioBuffer<float>> clip);
+
+    /**
+     * @brief Stops the audition. Message thread only.
+     */
+    void stop() { play (nullptr); }
+
+    /**
+     * @brief Replaces the content of buffer with the next samples of the
+     *        audition, if one is playing. Never blocks. Audio thread only.
+     *
+     * @return true if buffer now holds the audition.
+     */
+    bool process (juce::AudioBuffer<float>& buffer);
+
+private:
+    juce::SpinLock mLock;
+    std::unique_ptr<juce::AudioBuffer<float>> mClip; // under mLock
+    int mPosition = 0;                               // under mLock
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetAuditionPlayer)
+};
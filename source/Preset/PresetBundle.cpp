@@ -0,0 +1,209 @@
+#include "PresetBundle.hpp"
+#include "Preset.hpp"
+#include "juce_core/juce_core.h"
+#include "juce_events/juce_events.h"
+#include <cstring>
+
+namespace
+{
+    const char bundleMagic[] = { 'D', 'E', 'E', 'B' };
+}
+
+bool PresetBundle::write (const juce::Array<juce::File>& presetFiles, const juce::File& bundleFile, const ProgressCallback& onProgress)
+{
+    juce::Array<IndexEntry> index;
+    juce::MemoryOutputStream data;
+
+    // Deflate every record first, the index needs their offsets and sizes.
+    for (int i = 0; i < presetFiles.size(); ++i)
+    {
+        const auto xmlText = presetFiles[i].loadFileAsString();
+        auto element = juce::XmlDocument::parse (xmlText);
+
+        if (element != nullptr && element->hasTagName ("PRESET"))
+        {
+            const auto preset = Preset::fromXml (*element);
+            const auto rawData = xmlText.toRawUTF8();
+            const auto rawSize = static_cast<int> (xmlText.getNumBytesAsUTF8());
+
+            IndexEntry entry { preset.presetName, preset.authorName, preset.category, data.getPosition(), 0, rawSize };
+            {
+                juce::GZIPCompressorOutputStream compressor (data, 9);
+                compressor.write (rawData, static_cast<size_t> (rawSize));
+            }
+            entry.compressedSize = static_cast<int> (data.getPosition() - entry.offset);
+            index.add (entry);
+        }
+
+        if (onProgress != nullptr && !onProgress (0.9 * (i + 1) / presetFiles.size()))
+            return false;
+    }
+
+    juce::TemporaryFile temporaryFile (bundleFile);
+    {
+        juce::FileOutputStream output (temporaryFile.getFile());
+        if (output.failedToOpen())
+            return false;
+
+        output.write (bundleMagic, sizeof (bundleMagic));
+        output.writeInt (version);
+        output.writeInt (index.size());
+
+        for (const auto& entry : index)
+        {
+            output.writeString (entry.name);
+            output.writeString (entry.author);
+            output.writeString (entry.category);
+            output.writeInt64 (entry.offset);
+            output.writeInt (entry.compressedSize);
+            output.writeInt (entry.size);
+        }
+
+        output.write (data.getData(), data.getDataSize());
+        output.flush();
+
+        if (output.getStatus().failed())
+            return false;
+    }
+
+    if (onProgress != nullptr)
+        onProgress (1.0);
+
+    return temporaryFile.overwriteTargetFileWithTemporary();
+}
+
+bool PresetBundle::read (const juce::File& bundleFile, const juce::File& presetsDirectory, const ProgressCallback& onProgress, juce::Array<juce::File>& writtenFiles)
+{
+    juce::FileInputStream input (bundleFile);
+    if (input.failedToOpen())
+        return false;
+
+    char magic[sizeof (bundleMagic)] = {};
+    if (input.read (magic, sizeof (magic)) != sizeof (magic) || std::memcmp (magic, bundleMagic, sizeof (magic)) != 0)
+        return false;
+
+    if (input.readInt() != version)
+        return false;
+
+    const auto numRecords = input.readInt();
+    if (numRecords < 0)
+        return false;
+
+    juce::Array<IndexEntry> index;
+    for (int i = 0; i < numRecords; ++i)
+    {
+        if (input.isExhausted())
+            return false; // truncated index
+
+        IndexEntry entry;
+        entry.name           = input.readString();
+        entry.author         = input.readString();
+        entry.category       = input.readString();
+        entry.offset         = input.readInt64();
+        entry.compressedSize = input.readInt();
+        entry.size           = input.readInt();
+        index.add (entry);
+    }
+
+    const auto dataStart = input.getPosition();
+    juce::MemoryBlock compressed;
+    bool succeeded = true;
+
+    // Records are streamed one by one straight to the presets folder.
+    for (int i = 0; i < index.size(); ++i)
+    {
+        const auto& entry = index.getReference (i);
+
+        // The sizes come from the file: never allocate more than what's left of it.
+        if (entry.compressedSize > 0
+            && entry.offset >= 0
+            && input.setPosition (dataStart + entry.offset)
+            && entry.compressedSize <= input.getNumBytesRemaining())
+        {
+            compressed.setSize (static_cast<size_t> (entry.compressedSize));
+
+            if (input.read (compressed.getData(), entry.compressedSize) == entry.compressedSize)
+            {
+                juce::MemoryInputStream compressedStream (compressed, false);
+                juce::GZIPDecompressorInputStream decompressor (&compressedStream, false, juce::GZIPDecompressorInputStream::zlibFormat, entry.size);
+                const auto xmlText = decompressor.readEntireStreamAsString();
+
+                auto element = juce::XmlDocument::parse (xmlText);
+                if (element != nullptr && element->hasTagName ("PRESET"))
+                {
+                    const auto presetFile = getTargetFile (entry.name, presetsDirectory);
+
+                    if (presetFile != juce::File() && presetFile.replaceWithText (xmlText))
+                        writtenFiles.add (presetFile);
+                    else
+                        succeeded = false;
+                }
+            }
+        }
+
+        if (onProgress != nullptr && !onProgress (static_cast<double> (i + 1) / index.size()))
+            return false;
+    }
+
+    return succeeded;
+}
+
+juce::File PresetBundle::getTargetFile (const juce::String& presetName, const juce::File& presetsDirectory)
+{
+    // The name comes from the bundle: no path separators, no "..", no reserved characters.
+    auto fileName = juce::File::createLegalFileName (presetName.removeCharacters (" ")).trimCharactersAtStart (".");
+    if (fileName.isEmpty())
+        fileName = "Preset";
+
+    const auto presetFile = presetsDirectory.getChildFile (fileName + ".xml");
+    if (!presetFile.isAChildOf (presetsDirectory))
+        return {};
+
+    // Never overwrite a preset that is already there, "Name (2).xml" instead.
+    return presetFile.getNonexistentSibling();
+}
+
+//==============================================================================
+PresetBundleJob::PresetBundleJob (Direction direction, juce::File bundleFile, juce::File presetsDirectory, juce::Array<juce::File> presetFiles)
+    : juce::Thread ("Preset bundle"),
+      mDirection (direction),
+      mBundleFile (std::move (bundleFile)),
+      mPresetsDirectory (std::move (presetsDirectory)),
+      mPresetFiles (std::move (presetFiles))
+{
+}
+
+PresetBundleJob::~PresetBundleJob()
+{
+    stopThread (4000);
+}
+
+void PresetBundleJob::run()
+{
+    auto onProgress = [this] (double progress)
+    {
+        mProgress = progress;
+        return !threadShouldExit();
+    };
+
+    juce::Array<juce::File> importedFiles;
+    bool succeeded = false;
+
+    if (mDirection == Direction::exportBundle)
+    {
+        succeeded = PresetBundle::write (mPresetFiles, mBundleFile, onProgress);
+    }
+    else
+    {
+        succeeded = PresetBundle::read (mBundleFile, mPresetsDirectory, onProgress, importedFiles);
+    }
+
+    if (threadShouldExit())
+        return;
+
+    juce::MessageManager::callAsync ([callback = onFinished, importedFiles, succeeded]()
+    {
+        if (callback != nullptr)
+            callback (importedFiles, succeeded);
+    });
+}
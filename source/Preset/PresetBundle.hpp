@@ -0,0 +1,110 @@
+#pragma once
+
+#include "juce_core/juce_core.h"
+#include <functional>
+
+/**
+ * @brief A single file holding a whole preset library.
+ *
+ *        Layout (little endian, juce::OutputStream conventions):
+ *          - "DEEB" magic, int version, int number of records
+ *          - the index: for each record its name, author and category,
+ *            then int64 offset (from the start of the data), int compressed
+ *            size and int uncompressed size
+ *          - the data: every record is the preset's XML, deflated (zlib).
+ *
+ *        The index comes first so an import can check the bundle and
+ *        report progress before decompressing anything.
+ */
+class PresetBundle
+{
+public:
+    static constexpr int version = 1;
+    static constexpr const char* fileExtension = ".deeeeee";
+
+    /**
+     * @brief Called after each record with the progress in [0, 1].
+     *        Returning false aborts the operation.
+     */
+    using ProgressCallback = std::function<bool (double)>;
+
+    /**
+     * @brief Packs presetFiles into bundleFile. The bundle is written
+     *        to a temporary file first, so an aborted or failed export
+     *        never leaves a half-written bundle behind.
+     *
+     * @return true on success.
+     */
+    static bool write (const juce::Array<juce::File>& presetFiles, const juce::File& bundleFile, const ProgressCallback& onProgress);
+
+    /**
+     * @brief Unpacks bundleFile into presetsDirectory, one record at a time.
+     *        Records that aren't a valid <PRESET> are skipped, a preset
+     *        whose file already exists is written next to it under a
+     *        new name, never over it.
+     *
+     * @param writtenFiles receives the preset files that were written.
+     * @return true if the bundle could be read and every preset written,
+     *         an empty bundle included.
+     */
+    static bool read (const juce::File& bundleFile, const juce::File& presetsDirectory, const ProgressCallback& onProgress, juce::Array<juce::File>& writtenFiles);
+
+private:
+    /**
+     * @brief Where the preset named presetName is unpacked: a legal,
+     *        unused file name inside presetsDirectory, or File() if
+     *        there is none.
+     */
+    static juce::File getTargetFile (const juce::String& presetName, const juce::File& presetsDirectory);
+
+    struct IndexEntry
+    {
+        juce::String name, author, category;
+        juce::int64 offset = 0;
+        int compressedSize = 0;
+        int size = 0;
+    };
+};
+
+/**
+ * @brief Runs a bundle import or export on a background thread.
+ *        Progress can be read from the message thread through
+ *        getProgress(), onFinished is called on the message thread.
+ */
+class PresetBundleJob : public juce::Thread
+{
+public:
+    enum class Direction
+    {
+        importBundle,
+        exportBundle
+    };
+
+    /**
+     * @param direction import or export.
+     * @param bundleFile the bundle to read or write.
+     * @param presetsDirectory where imported presets are written.
+     * @param presetFiles the presets to export, ignored on import.
+     */
+    PresetBundleJob (Direction direction, juce::File bundleFile, juce::File presetsDirectory, juce::Array<juce::File> presetFiles);
+    ~PresetBundleJob() override;
+
+    void run() override;
+
+    double& getProgress() { return mProgress; }
+
+    /**
+     * @brief Called on the message thread once the job is done,
+     *        with the files that were imported (empty for an export)
+     *        and whether it succeeded.
+     */
+    std::function<void (const juce::Array<juce::File>&, bool)> onFinished;
+
+private:
+    Direction mDirection;
+    juce::File mBundleFile, mPresetsDirectory;
+    juce::Array<juce::File> mPresetFiles;
+    double mProgress = 0.0; // polled by a juce::ProgressBar
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBundleJob)
+};
@@ -0,0 +1,280 @@
+#include "PresetIndex.hpp"
+#include "juce_core/juce_core.h"
+#include "juce_events/juce_events.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+PresetIndex::PresetIndex (juce::File presetsDirectory) : mDirectory (std::move (presetsDirectory))
+{
+}
+
+void PresetIndex::rescan()
+{
+    applyScan (listFiles (mDirectory), nullptr);
+}
+
+void PresetIndex::rescanAsync (std::function<void()> onFinished)
+{
+    juce::Thread::launch ([directory = mDirectory, weakThis = juce::WeakReference<PresetIndex> (this), onFinished = std::move (onFinished)]() mutable
+    {
+        if (!directory.isDirectory())
+            directory.createDirectory(); // and every missing parent
+
+        auto entries = std::make_shared<std::vector<Entry>> (listFiles (directory));
+
+        juce::MessageManager::callAsync ([weakThis, entries, onFinished = std::move (onFinished)]()
+        {
+            if (auto* index = weakThis.get())
+                index->applyScan (std::move (*entries), onFinished);
+        });
+    });
+}
+
+std::vector<PresetIndex::Entry> PresetIndex::listFiles (const juce::File& directory)
+{
+    std::vector<Entry> entries;
+
+    for (const auto& entry : juce::RangedDirectoryIterator (directory, false, "*.xml", juce::File::findFiles))
+    {
+        Entry newEntry;
+        newEntry.file = entry.getFile();
+        newEntry.modificationTime = entry.getModificationTime();
+        entries.push_back (std::move (newEntry));
+    }
+
+    // Until the user picks a column, the file names give a cheap and stable order.
+    std::sort (entries.begin(), entries.end(), [] (const Entry& a, const Entry& b)
+               { return a.file.getFileName().compareNatural (b.file.getFileName()) < 0; });
+
+    return entries;
+}
+
+void PresetIndex::applyScan (std::vector<Entry> entries, std::function<void()> onFinished)
+{
+    // Keep the already parsed information of unchanged files.
+    for (auto& newEntry : entries)
+    {
+        const auto* previous = findEntry (newEntry.file);
+        if (previous != nullptr && previous->modificationTime == newEntry.modificationTime)
+            newEntry = *previous;
+    }
+
+    mEntries = std::move (entries);
+    updateFileMap();
+    mOrder.resize (mEntries.size());
+    std::iota (mOrder.begin(), mOrder.end(), 0);
+
+    if (mIsSorted)
+    {
+        sort (mSortKey, mSortForwards, std::move (onFinished));
+        return;
+    }
+
+    updateRows();
+    if (onFinished != nullptr)
+        onFinished();
+}
+
+void PresetIndex::addOrUpdate (const juce::Array<juce::File>& files, std::function<void()> onUpdated)
+{
+    for (const auto& file : files)
+    {
+        if (auto* existing = findEntry (file))
+        {
+            *existing = { file, file.getLastModificationTime() };
+            continue;
+        }
+
+        mEntryOfFile[file.getFullPathName()] = static_cast<int> (mEntries.size());
+        mEntries.push_back ({ file, file.getLastModificationTime() });
+        mOrder.push_back (static_cast<int> (mEntries.size()) - 1);
+    }
+
+    // Once for the whole batch.
+    if (mIsSorted)
+    {
+        sort (mSortKey, mSortForwards, std::move (onUpdated));
+        return;
+    }
+
+    updateRows();
+    if (onUpdated != nullptr)
+        onUpdated();
+}
+
+void PresetIndex::remove (const juce::File& file)
+{
+    const auto found = mEntryOfFile.find (file.getFullPathName());
+    if (found == mEntryOfFile.end())
+        return;
+
+    const auto entryIndex = found->second;
+    mOrder.erase (mOrder.begin() + mRowOfEntry[static_cast<size_t> (entryIndex)]);
+    mEntries.erase (mEntries.begin() + entryIndex);
+
+    for (auto& index : mOrder)
+        if (index > entryIndex)
+            --index;
+
+    updateFileMap();
+    updateRows();
+}
+
+const PresetIndex::Entry& PresetIndex::getEntry (int row)
+{
+    jassert (juce::isPositiveAndBelow (row, size()));
+
+    auto& entry = mEntries[static_cast<size_t> (mOrder[static_cast<size_t> (row)])];
+    if (!entry.infoLoaded)
+        loadInfo (entry);
+
+    return entry;
+}
+
+const juce::File& PresetIndex::getFile (int row) const
+{
+    jassert (juce::isPositiveAndBelow (row, size()));
+    return mEntries[static_cast<size_t> (mOrder[static_cast<size_t> (row)])].file;
+}
+
+Preset PresetIndex::loadPreset (int row) const
+{
+    if (!juce::isPositiveAndBelow (row, size()))
+        return {};
+
+    const auto& file = mEntries[static_cast<size_t> (mOrder[static_cast<size_t> (row)])].file;
+    if (auto element = juce::XmlDocument::parse (file))
+        return Preset::fromXml (*element);
+
+    return {};
+}
+
+int PresetIndex::indexOfFile (const juce::File& file) const
+{
+    const auto found = mEntryOfFile.find (file.getFullPathName());
+    return found != mEntryOfFile.end() ? mRowOfEntry[static_cast<size_t> (found->second)] : -1;
+}
+
+void PresetIndex::sort (SortKey key, bool forwards, std::function<void()> onSorted)
+{
+    mSortKey = key;
+    mSortForwards = forwards;
+    mIsSorted = true;
+    const auto generation = ++mSortGeneration;
+
+    // Sorting by a text column needs every INFORMATION node,
+    // sorting by date only needs what the scan already gave us.
+    std::vector<Entry> missing;
+    if (key != SortKey::modificationDate)
+        for (const auto& entry : mEntries)
+            if (!entry.infoLoaded)
+                missing.push_back ({ entry.file, entry.modificationTime });
+
+    if (missing.empty())
+    {
+        sortRows();
+        if (onSorted != nullptr)
+            onSorted();
+        return;
+    }
+
+    // Parsing a whole library would block the message thread.
+    juce::Thread::launch ([missing = std::move (missing), weakThis = juce::WeakReference<PresetIndex> (this), generation, onSorted = std::move (onSorted)]() mutable
+    {
+        for (auto& entry : missing)
+            loadInfo (entry);
+
+        auto loaded = std::make_shared<std::vector<Entry>> (std::move (missing));
+
+        juce::MessageManager::callAsync ([weakThis, loaded, generation, onSorted = std::move (onSorted)]()
+        {
+            auto* index = weakThis.get();
+            if (index == nullptr || generation != index->mSortGeneration)
+                return;
+
+            // Files added or changed meanwhile are picked up by going round again.
+            index->applyInfo (*loaded);
+            index->sort (index->mSortKey, index->mSortForwards, onSorted);
+        });
+    });
+}
+
+void PresetIndex::applyInfo (const std::vector<Entry>& loaded)
+{
+    for (const auto& info : loaded)
+    {
+        auto* entry = findEntry (info.file);
+        if (entry != nullptr && !entry->infoLoaded && entry->modificationTime == info.modificationTime)
+            *entry = info;
+    }
+}
+
+void PresetIndex::sortRows()
+{
+    auto compare = [this] (int a, int b)
+    {
+        const auto& first = mEntries[static_cast<size_t> (a)];
+        const auto& second = mEntries[static_cast<size_t> (b)];
+
+        switch (mSortKey)
+        {
+            case SortKey::name:             return first.name.compareNatural (second.name) < 0;
+            case SortKey::author:           return first.author.compareNatural (second.author) < 0;
+            case SortKey::category:         return first.category.compareNatural (second.category) < 0;
+            case SortKey::modificationDate: return first.modificationTime < second.modificationTime;
+        }
+        return false;
+    };
+
+    if (mSortForwards)
+        std::stable_sort (mOrder.begin(), mOrder.end(), compare);
+    else
+        std::stable_sort (mOrder.begin(), mOrder.end(), [&compare] (int a, int b) { return compare (b, a); });
+
+    updateRows();
+}
+
+void PresetIndex::updateRows()
+{
+    mRowOfEntry.resize (mOrder.size());
+    for (size_t row = 0; row < mOrder.size(); ++row)
+        mRowOfEntry[static_cast<size_t> (mOrder[row])] = static_cast<int> (row);
+}
+
+void PresetIndex::updateFileMap()
+{
+    mEntryOfFile.clear();
+    mEntryOfFile.reserve (mEntries.size());
+
+    for (size_t i = 0; i < mEntries.size(); ++i)
+        mEntryOfFile[mEntries[i].file.getFullPathName()] = static_cast<int> (i);
+}
+
+PresetIndex::Entry* PresetIndex::findEntry (const juce::File& file)
+{
+    const auto found = mEntryOfFile.find (file.getFullPathName());
+    return found != mEntryOfFile.end() ? &mEntries[static_cast<size_t> (found->second)] : nullptr;
+}
+
+void PresetIndex::loadInfo (Entry& entry)
+{
+    entry.infoLoaded = true;
+
+    const auto content = entry.file.loadFileAsString();
+    entry.contentHash = content.hashCode64();
+
+    auto element = juce::XmlDocument::parse (content);
+    if (element == nullptr || !element->hasTagName ("PRESET"))
+    {
+        entry.name = entry.file.getFileNameWithoutExtension();
+        return;
+    }
+
+    if (auto* info = element->getChildByName ("INFORMATION"))
+    {
+        entry.name     = info->getStringAttribute ("Name", entry.file.getFileNameWithoutExtension());
+        entry.author   = info->getStringAttribute ("Author");
+        entry.category = info->getStringAttribute ("Category");
+    }
+}
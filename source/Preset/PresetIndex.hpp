@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Preset.hpp"
+#include "juce_core/juce_core.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A lightweight index over the preset folder.
+ *
+ *        Scanning only lists the files and their modification date,
+ *        which is cheap even for very large libraries. The INFORMATION
+ *        node of a preset (name, author, category) is parsed the first
+ *        time a row asks for it and then kept, while the parameter values
+ *        are only read from disk when a preset is actually loaded.
+ *
+ *        Rows are exposed in the current sort order. Files are looked up
+ *        through a hash map and rows through the inverse of the order,
+ *        so neither costs a pass over the library.
+ *        Must only be used from the message thread.
+ */
+class PresetIndex
+{
+public:
+    enum class SortKey
+    {
+        name,
+        author,
+        category,
+        modificationDate
+    };
+
+    struct Entry
+    {
+        juce::File file;
+        juce::Time modificationTime;
+
+        bool infoLoaded = false;
+        juce::String name, author, category;
+        juce::int64 contentHash = 0; // hash of the whole file, set with the information
+    };
+
+    explicit PresetIndex (juce::File presetsDirectory);
+
+    /**
+     * @brief (Re)lists the preset files of the directory.
+     *        Already parsed information is kept for unchanged files.
+     *        Sorted by a text column, the rows may only be in order
+     *        once sort() is done, see there.
+     */
+    void rescan();
+
+    /**
+     * @brief Same as rescan(), but the directory is created if needed
+     *        and listed on a background thread. The result is applied
+     *        on the message thread, then onFinished is called. Nothing
+     *        happens if the index is gone by then.
+     */
+    void rescanAsync (std::function<void()> onFinished);
+
+    /**
+     * @brief Adds preset files to the index, or refreshes those that
+     *        are already indexed (e.g. after an overwrite). The rows are
+     *        sorted once for the whole batch, then onUpdated is called.
+     */
+    void addOrUpdate (const juce::Array<juce::File>& files, std::function<void()> onUpdated = nullptr);
+
+    /**
+     * @brief Takes file out of the index, if it's there.
+     */
+    void remove (const juce::File& file);
+
+    int size() const { return static_cast<int> (mOrder.size()); }
+
+    /**
+     * @brief Returns the entry displayed at row, parsing its
+     *        information first if that hasn't been done yet.
+     */
+    const Entry& getEntry (int row);
+
+    /**
+     * @brief Returns the file displayed at row, without parsing it.
+     */
+    const juce::File& getFile (int row) const;
+
+    /**
+     * @brief Reads the whole preset displayed at row from disk.
+     */
+    Preset loadPreset (int row) const;
+
+    /**
+     * @brief Returns the row of file, or -1 if it isn't indexed.
+     */
+    int indexOfFile (const juce::File& file) const;
+
+    /**
+     * @brief Sorts the rows, then calls onSorted.
+     *
+     *        Sorting by date, or by a text column once every INFORMATION
+     *        node is known, is done right away. Otherwise the missing ones
+     *        are parsed on a background thread and the rows sorted when
+     *        they're back. onSorted isn't called if sort() is called
+     *        again in the meantime, or if the index is gone.
+     */
+    void sort (SortKey key, bool forwards, std::function<void()> onSorted = nullptr);
+
+    const juce::File& getDirectory() const { return mDirectory; }
+
+private:
+    /**
+     * @brief Lists the preset files of directory and their modification
+     *        date. Doesn't touch the index, can run on any thread.
+     */
+    static std::vector<Entry> listFiles (const juce::File& directory);
+
+    /**
+     * @brief Replaces the entries with the result of listFiles(),
+     *        then sorts them like they were and calls onFinished.
+     */
+    void applyScan (std::vector<Entry> entries, std::function<void()> onFinished);
+
+    /**
+     * @brief Copies the information parsed off the message thread
+     *        to the entries, unless their file changed since.
+     */
+    void applyInfo (const std::vector<Entry>& loaded);
+
+    /**
+     * @brief Parses only what the browser displays for entry.
+     *        Only touches entry, can run on any thread.
+     */
+    static void loadInfo (Entry& entry);
+
+    /**
+     * @brief Sorts mOrder with what the entries hold now.
+     */
+    void sortRows();
+
+    /**
+     * @brief Brings mRowOfEntry back in line with mOrder.
+     */
+    void updateRows();
+
+    /**
+     * @brief Rebuilds mEntryOfFile from mEntries.
+     */
+    void updateFileMap();
+
+    Entry* findEntry (const juce::File& file);
+
+    juce::File mDirectory;
+    std::vector<Entry> mEntries;
+    std::vector<int> mOrder;                                // row -> index in mEntries
+    std::vector<int> mRowOfEntry;                           // index in mEntries -> row
+    std::unordered_map<juce::String, int> mEntryOfFile;     // full path -> index in mEntries
+
+    SortKey mSortKey = SortKey::name;
+    bool mSortForwards = true;
+    bool mIsSorted = false;
+    int mSortGeneration = 0; // the last sort() asked for, the ones waiting for information before it give up
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (PresetIndex)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetIndex)
+};
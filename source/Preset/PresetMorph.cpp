@@ -0,0 +1,198 @@
+#include "PresetMorph.hpp"
+#include "juce_audio_basics/juce_audio_basics.h"
+
+void PresetMorph::setSlot (Slot slot, std::optional<Preset> preset)
+{
+    {
+        const juce::ScopedLock lock (mSlotsLock);
+        (slot == Slot::a ? mSlotA : mSlotB) = std::move (preset);
+        updateVectors();
+    }
+
+    sendChangeMessage();
+}
+
+bool PresetMorph::hasSlot (Slot slot) const
+{
+    const juce::ScopedLock lock (mSlotsLock);
+    return (slot == Slot::a ? mSlotA : mSlotB).has_value();
+}
+
+juce::ValueTree PresetMorph::getState() const
+{
+    juce::ValueTree state { stateType };
+
+    // The presets are stored the same way as in their files.
+    auto addSlot = [&state] (const std::optional<Preset>& preset, const juce::String& name)
+    {
+        if (!preset.has_value())
+            return;
+
+        auto child = juce::ValueTree::fromXml (*preset->toXml());
+        child.setProperty ("Slot", name, nullptr);
+        state.appendChild (child, nullptr);
+    };
+
+    const juce::ScopedLock lock (mSlotsLock);
+    addSlot (mSlotA, "A");
+    addSlot (mSlotB, "B");
+
+    return state;
+}
+
+void PresetMorph::setState (const juce::ValueTree& state)
+{
+    std::optional<Preset> slotA, slotB;
+
+    for (const auto& child : state)
+    {
+        if (auto xml = child.createXml())
+        {
+            auto& slot = child["Slot"].toString() == "A" ? slotA : slotB;
+            slot = Preset::fromXml (*xml);
+        }
+    }
+
+    {
+        const juce::ScopedLock lock (mSlotsLock);
+        mSlotA = std::move (slotA);
+        mSlotB = std::move (slotB);
+        updateVectors();
+    }
+
+    sendChangeMessage();
+}
+
+void PresetMorph::updateVectors()
+{
+    Vectors vectors;
+
+    if (mSlotA.has_value() && mSlotB.has_value())
+    {
+        vectors.active = true;
+        vectors.start = toContinuous (*mSlotA);
+        vectors.range = toContinuous (*mSlotB);
+        juce::FloatVectorOperations::subtract (vectors.range.data(), vectors.start.data(), numContinuous);
+        vectors.discreteA = toDiscrete (*mSlotA);
+        vectors.discreteB = toDiscrete (*mSlotB);
+    }
+
+    const juce::SpinLock::ScopedLockType lock (mLock);
+    mPending = vectors;
+    mHasPending = true;
+}
+
+bool PresetMorph::updateFromMessageThread()
+{
+    const juce::SpinLock::ScopedTryLockType lock (mLock);
+
+    if (lock.isLocked() && mHasPending)
+    {
+        mCurrent = mPending;
+        mHasPending = false;
+    }
+
+    return mCurrent.active;
+}
+
+PresetMorph::Values PresetMorph::getValuesAt (float position) const
+{
+    position = juce::jlimit (0.0f, 1.0f, position);
+
+    std::array<float, numContinuous> v;
+    juce::FloatVectorOperations::copy (v.data(), mCurrent.start.data(), numContinuous);
+    juce::FloatVectorOperations::addWithMultiply (v.data(), mCurrent.range.data(), position, numContinuous);
+
+    const auto& discrete = position < 0.5f ? mCurrent.discreteA : mCurrent.discreteB;
+
+    Values values;
+    values.delay.timeMs     = juce::roundToInt (v[delayTime]);
+    values.delay.feedback   = v[delayFeedback];
+    values.delay.syncToggle = discrete[delaySyncToggle] != 0;
+    values.delay.syncIndex  = discrete[delaySyncDivider];
+
+    values.delay.modRate    = v[delayModRate];
+    values.delay.modDepthMs = v[delayModDepth];
+    values.delay.modShape   = discrete[delayModShape];
+    values.delay.modStereo  = v[delayModStereo];
+
+    values.delay.mode                  = discrete[delayMode];
+    values.delay.grainSizeMs           = v[delayGrainSize];
+    values.delay.grainDensity          = juce::roundToInt (v[delayGrainDensity]);
+    values.delay.grainPitchJitter      = v[delayGrainPitchJitter];
+    values.delay.grainPositionJitterMs = v[delayGrainPositionJitter];
+
+    values.delay.shimmer      = v[delayShimmer];
+    values.delay.shimmerPitch = discrete[delayShimmerPitch];
+
+    values.reverb.damping    = v[reverbDamping];
+    values.reverb.roomSize   = v[reverbRoomSize];
+    values.reverb.wetLevel   = v[reverbWet];
+    values.reverb.dryLevel   = v[reverbDry];
+    values.reverb.width      = v[reverbWidth];
+    values.reverb.freezeMode = static_cast<float> (discrete[reverbFreeze]);
+
+    values.dryWet = v[pluginDryWet];
+    values.level  = v[pluginLevel];
+    values.gain   = v[pluginGain];
+
+    values.ducker.depth     = v[duckDepth];
+    values.ducker.threshold = v[duckThreshold];
+    values.ducker.attack    = v[duckAttack];
+    values.ducker.release   = v[duckRelease];
+    values.ducker.lookahead = discrete[duckLookahead] != 0;
+    values.ducker.source    = discrete[duckSource];
+
+    values.midSide.width             = v[stereoWidth];
+    values.midSide.midGain           = v[midGain];
+    values.midSide.sideGain          = v[sideGain];
+    values.midSide.bassMonoFrequency = v[bassMonoFrequency];
+
+    return values;
+}
+
+std::array<float, PresetMorph::numContinuous> PresetMorph::toContinuous (const Preset& preset)
+{
+    std::array<float, numContinuous> v;
+    v[delayTime]      = static_cast<float> (preset.delayTime);
+    v[delayFeedback]  = preset.delayFeedback;
+    v[delayModRate]   = preset.delayModRate;
+    v[delayModDepth]  = preset.delayModDepth;
+    v[delayModStereo] = preset.delayModStereo;
+    v[delayGrainSize]           = preset.delayGrainSize;
+    v[delayGrainDensity]        = static_cast<float> (preset.delayGrainDensity);
+    v[delayGrainPitchJitter]    = preset.delayGrainPitchJitter;
+    v[delayGrainPositionJitter] = preset.delayGrainPositionJitter;
+    v[delayShimmer]   = preset.delayShimmer;
+    v[reverbDamping]  = preset.reverbDamping;
+    v[reverbRoomSize] = preset.reverbRoomSize;
+    v[reverbWet]      = preset.reverbWet;
+    v[reverbDry]      = preset.reverbDry;
+    v[reverbWidth]    = preset.reverbWidth;
+    v[pluginDryWet]   = preset.pluginDryWet;
+    v[pluginLevel]    = preset.pluginLevel;
+    v[pluginGain]     = preset.pluginGain;
+    v[duckDepth]      = preset.duckDepth;
+    v[duckThreshold]  = preset.duckThreshold;
+    v[duckAttack]     = preset.duckAttack;
+    v[duckRelease]    = preset.duckRelease;
+    v[stereoWidth]    = preset.stereoWidth;
+    v[midGain]        = preset.midGain;
+    v[sideGain]       = preset.sideGain;
+    v[bassMonoFrequency] = preset.bassMonoFrequency;
+    return v;
+}
+
+std::array<int, PresetMorph::numDiscrete> PresetMorph::toDiscrete (const Preset& preset)
+{
+    std::array<int, numDiscrete> d;
+    d[delaySyncToggle]  = preset.delaySyncToggleState ? 1 : 0;
+    d[delaySyncDivider] = preset.delaySyncDivider;
+    d[delayModShape]    = preset.delayModShape;
+    d[delayMode]        = preset.delayMode;
+    d[delayShimmerPitch] = preset.delayShimmerPitch;
+    d[reverbFreeze]     = preset.reverbFreezeState ? 1 : 0;
+    d[duckLookahead]    = preset.duckLookahead ? 1 : 0;
+    d[duckSource]       = preset.duckSource;
+    return d;
+}
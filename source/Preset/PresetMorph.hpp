@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../Delay/Delay.hpp"
+#include "../Ducker/Ducker.hpp"
+#include "../MidSide/MidSide.hpp"
+#include "Preset.hpp"
+#include "juce_core/juce_core.h"
+#include "juce_data_structures/juce_data_structures.h"
+#include "juce_dsp/juce_dsp.h"
+#include "juce_events/juce_events.h"
+#include <array>
+#include <optional>
+
+/**
+ * @brief Interpolates between two presets, A and B.
+ *
+ *        The presets are turned into vectors once, on the message thread,
+ *        when a slot is set. The audio thread then only evaluates
+ *        a + position * (b - a) over those vectors every block, without
+ *        going through the APVTS. Continuous values are interpolated,
+ *        discrete ones (sync, freeze, delay mode, mod shape, shimmer pitch,
+ *        duck lookahead and source) switch at the midpoint.
+ *
+ *        The two presets are kept in slots, which are part of the plugin
+ *        state (see getState()), so the morph is the same whether an editor
+ *        is open or not, and after a session is reloaded. Listeners are told
+ *        when a slot changes.
+ */
+class PresetMorph : public juce::ChangeBroadcaster
+{
+public:
+    /**
+     * @brief Everything the processor needs for one block.
+     */
+    struct Values
+    {
+        Delay::Parameters delay;
+        juce::dsp::Reverb::Parameters reverb;
+        Ducker::Parameters ducker;
+        MidSide::Parameters midSide;
+        float dryWet = 0.0f;
+        float level  = 0.0f;
+        float gain   = 1.0f;
+    };
+
+    enum class Slot
+    {
+        a,
+        b
+    };
+
+    PresetMorph() = default;
+
+    /**
+     * @brief Fills slot with preset, or empties it. The morph is active while
+     *        both slots are set, the processor goes back to the APVTS otherwise.
+     *        Not on the audio thread.
+     */
+    void setSlot (Slot slot, std::optional<Preset> preset);
+
+    bool hasSlot (Slot slot) const;
+
+    /**
+     * @brief The slots that are set, as a <MORPH> tree for the plugin state.
+     */
+    juce::ValueTree getState() const;
+
+    /**
+     * @brief Restores the slots of getState(), an invalid tree empties them.
+     */
+    void setState (const juce::ValueTree& state);
+
+    static inline const juce::Identifier stateType { "MORPH" };
+
+    /**
+     * @brief Picks up what the message thread may have set since the last
+     *        block. Never blocks: if the message thread is busy writing,
+     *        the previous vectors are kept for one more block.
+     *        Audio thread only.
+     *
+     * @return true if the morph is active.
+     */
+    bool updateFromMessageThread();
+
+    /**
+     * @brief Computes the values at position, 0 being A and 1 being B.
+     *        Audio thread only, after updateFromMessageThread().
+     */
+    Values getValuesAt (float position) const;
+
+private:
+    enum Continuous
+    {
+        delayTime = 0,
+        delayFeedback,
+        delayModRate,
+        delayModDepth,
+        delayModStereo,
+        delayGrainSize,
+        delayGrainDensity,
+        delayGrainPitchJitter,
+        delayGrainPositionJitter,
+        delayShimmer,
+        reverbDamping,
+        reverbRoomSize,
+        reverbWet,
+        reverbDry,
+        reverbWidth,
+        pluginDryWet,
+        pluginLevel,
+        pluginGain,
+        duckDepth,
+        duckThreshold,
+        duckAttack,
+        duckRelease,
+        stereoWidth,
+        midGain,
+        sideGain,
+        bassMonoFrequency,
+        numContinuous
+    };
+
+    enum Discrete
+    {
+        delaySyncToggle = 0,
+        delaySyncDivider,
+        delayModShape,
+        delayMode,
+        delayShimmerPitch,
+        reverbFreeze,
+        duckLookahead,
+        duckSource,
+        numDiscrete
+    };
+
+    struct Vectors
+    {
+        bool active = false;
+        std::array<float, numContinuous> start {}, range {}; // A, and B - A
+        std::array<int, numDiscrete> discreteA {}, discreteB {};
+    };
+
+    static std::array<float, numContinuous> toContinuous (const Preset& preset);
+    static std::array<int, numDiscrete> toDiscrete (const Preset& preset);
+
+    /**
+     * @brief Sends the slots to the audio thread. Called under mSlotsLock.
+     */
+    void updateVectors();
+
+    juce::CriticalSection mSlotsLock; // the host may save or restore the state from any thread
+    std::optional<Preset> mSlotA, mSlotB;
+
+    juce::SpinLock mLock;
+    Vectors mPending;               // written by the message thread, under mLock
+    bool mHasPending = false;       // under mLock
+    Vectors mCurrent;               // audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetMorph)
+};
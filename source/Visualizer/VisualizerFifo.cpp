@@ -0,0 +1,132 @@
+#include "VisualizerFifo.hpp"
+
+void VisualizerFifo::prepare (double sampleRate)
+{
+    mSamplesPerFrame = juce::jmax (1, static_cast<int> (sampleRate / framesPerSecond));
+
+    mPending = {};
+    mSumOfSquares = {};
+    mNumAccumulated = 0;
+
+    // The delay buffer may have a new size, rebuild the whole view.
+    mDelayBufferLength = 0;
+}
+
+void VisualizerFifo::setEditorAttached (bool isAttached)
+{
+    mEditorAttached.store (isAttached, std::memory_order_release);
+}
+
+void VisualizerFifo::push (const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& delayBuffer, int writePosition, int delayInSamples)
+{
+    const auto isAttached = mEditorAttached.load (std::memory_order_acquire);
+    const auto justAttached = isAttached && !mWasAttached;
+    mWasAttached = isAttached;
+
+    if (!isAttached)
+        return;
+
+    const auto numSamples = output.getNumSamples();
+    const auto numChannels = juce::jmin (output.getNumChannels(), VisualizerFrame::maxChannels);
+
+    // Levels, accumulated over the frame.
+    mPending.numChannels = numChannels;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax (output.getReadPointer (channel), numSamples);
+        const auto index = static_cast<size_t> (channel);
+        mPending.peak[index] = juce::jmax (mPending.peak[index], -range.getStart(), range.getEnd());
+
+        const auto rms = output.getRMSLevel (channel, 0, numSamples);
+        mSumOfSquares[index] += static_cast<double> (rms) * static_cast<double> (rms) * numSamples;
+    }
+    mNumAccumulated += numSamples;
+
+    // The delay view only changes where the block was written. It's
+    // built from scratch when the editor shows up or the buffer changed.
+    const auto delayBufferLength = delayBuffer.getNumSamples();
+    if (delayBufferLength == 0)
+        return;
+
+    if (justAttached || delayBufferLength != mDelayBufferLength)
+    {
+        mDelayBufferLength = delayBufferLength;
+        updateDelayView (delayBuffer, 0, delayBufferLength);
+    }
+    else
+    {
+        updateDelayView (delayBuffer, writePosition, juce::jmin (numSamples, delayBufferLength));
+    }
+
+    if (mNumAccumulated < mSamplesPerFrame)
+        return;
+
+    const auto end = (writePosition + numSamples) % delayBufferLength;
+    mPending.writeHead = static_cast<float> (end) / static_cast<float> (delayBufferLength);
+    mPending.readHead = static_cast<float> ((delayBufferLength + end - delayInSamples % delayBufferLength) % delayBufferLength) / static_cast<float> (delayBufferLength);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto index = static_cast<size_t> (channel);
+        mPending.rms[index] = static_cast<float> (std::sqrt (mSumOfSquares[index] / mNumAccumulated));
+    }
+
+    // Dropped if the editor is late, it'll get the next one.
+    const auto scope = mFifo.write (1);
+    if (scope.blockSize1 > 0)
+        mFrames[static_cast<size_t> (scope.startIndex1)] = mPending;
+
+    mPending.peak = {};
+    mPending.rms = {};
+    mSumOfSquares = {};
+    mNumAccumulated = 0;
+}
+
+bool VisualizerFifo::pull (VisualizerFrame& frame)
+{
+    const auto numReady = mFifo.getNumReady();
+    if (numReady == 0)
+        return false;
+
+    const auto scope = mFifo.read (numReady);
+    const auto newest = scope.blockSize2 > 0 ? scope.startIndex2 + scope.blockSize2 - 1
+                                             : scope.startIndex1 + scope.blockSize1 - 1;
+    frame = mFrames[static_cast<size_t> (newest)];
+
+    return true;
+}
+
+void VisualizerFifo::updateDelayView (const juce::AudioBuffer<float>& delayBuffer, int start, int length)
+{
+    const auto delayBufferLength = delayBuffer.getNumSamples();
+
+    // The written region wraps around like the delay buffer does.
+    if (start + length > delayBufferLength)
+    {
+        updateDelayView (delayBuffer, start, delayBufferLength - start);
+        updateDelayView (delayBuffer, 0, start + length - delayBufferLength);
+        return;
+    }
+
+    if (length <= 0)
+        return;
+
+    const auto sliceLength = (delayBufferLength + VisualizerFrame::numDelayPoints - 1) / VisualizerFrame::numDelayPoints;
+    const auto firstSlice = start / sliceLength;
+    const auto lastSlice = juce::jmin (VisualizerFrame::numDelayPoints - 1, (start + length - 1) / sliceLength);
+
+    for (int slice = firstSlice; slice <= lastSlice; ++slice)
+    {
+        const auto sliceStart = slice * sliceLength;
+        const auto sliceSize = juce::jmin (sliceLength, delayBufferLength - sliceStart);
+
+        auto peak = 0.0f;
+        for (int channel = 0; channel < delayBuffer.getNumChannels() && sliceSize > 0; ++channel)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax (delayBuffer.getReadPointer (channel, sliceStart), sliceSize);
+            peak = juce::jmax (peak, -range.getStart(), range.getEnd());
+        }
+
+        mPending.delayView[static_cast<size_t> (slice)] = peak;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "juce_audio_basics/juce_audio_basics.h"
+#include "juce_core/juce_core.h"
+#include <array>
+#include <atomic>
+
+/**
+ * @brief What the editor gets to draw, about sixty times per second.
+ */
+struct VisualizerFrame
+{
+    static constexpr int maxChannels = 2;
+    static constexpr int numDelayPoints = 256;
+
+    std::array<float, maxChannels> peak {};
+    std::array<float, maxChannels> rms {};
+    int numChannels = 0;
+
+    // Peak of every slice of the delay buffer, over all its channels.
+    std::array<float, numDelayPoints> delayView {};
+
+    // Positions of the write and read heads, as proportions of the delay buffer.
+    float writeHead = 0.0f;
+    float readHead = 0.0f;
+};
+
+/**
+ * @brief Single producer (the audio thread), single consumer (the
+ *        message thread) FIFO of VisualizerFrame, on a juce::AbstractFifo.
+ *
+ *        The audio thread never blocks nor allocates: when the FIFO is
+ *        full the frame is dropped. Nothing at all is computed while
+ *        no editor is attached.
+ */
+class VisualizerFifo
+{
+public:
+    VisualizerFifo() = default;
+
+    /**
+     * @brief To be called inside the PluginProcessor::prepareToPlay method
+     *
+     * @param sampleRate the current sample rate
+     */
+    void prepare (double sampleRate);
+
+    /**
+     * @brief Called by the editor when it's created and destroyed.
+     */
+    void setEditorAttached (bool isAttached);
+
+    /**
+     * @brief Audio thread. Accumulates the levels of the block and
+     *        publishes a frame once enough samples went by.
+     *
+     * @param output the processed block
+     * @param delayBuffer the delay's circular buffer
+     * @param writePosition the write position at the start of the block
+     * @param delayInSamples the distance between the write and read heads
+     */
+    void push (const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& delayBuffer, int writePosition, int delayInSamples);
+
+    /**
+     * @brief Message thread. Empties the FIFO and keeps the newest frame.
+     *
+     * @return false if nothing was published since the last call.
+     */
+    bool pull (VisualizerFrame& frame);
+
+private:
+    /**
+     * @brief Updates the slices of the delay view in [start, start + length).
+     */
+    void updateDelayView (const juce::AudioBuffer<float>& delayBuffer, int start, int length);
+
+    static constexpr int numFrames = 8;
+    static constexpr double framesPerSecond = 60.0;
+
+    juce::AbstractFifo mFifo { numFrames };
+    std::array<VisualizerFrame, numFrames> mFrames;
+
+    std::atomic<bool> mEditorAttached { false };
+
+    // Audio thread only
+    VisualizerFrame mPending;
+    std::array<double, VisualizerFrame::maxChannels> mSumOfSquares {};
+    int mNumAccumulated = 0;
+    int mSamplesPerFrame = 735;
+    int mDelayBufferLength = 0;
+    bool mWasAttached = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VisualizerFifo)
+};
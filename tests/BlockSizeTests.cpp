@@ -0,0 +1,147 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+/* Hosts send blocks of any size up to the one given to prepareToPlay(), and
+ * the size changes from one block to the next. The output mustn't depend on it.
+ */
+namespace
+{
+    constexpr int renderLength = static_cast<int> (2.0 * RenderHelpers::sampleRate);
+    constexpr int maxBlockSize = 1024;
+
+    // Different block boundaries may reorder a few floating point operations (SIMD head and tail).
+    constexpr float toleranceDecibels = -100.0f;
+
+    // The LFO phase each chunk starts from is rounded to a float, moving the modulated read head by a hair.
+    constexpr float modulatedToleranceDecibels = -70.0f;
+
+    void checkBlockSizeInvariance (const std::function<void (PluginProcessor&)>& setUp, float tolerance = toleranceDecibels)
+    {
+        PluginProcessor singleBlockPlugin;
+        setUp (singleBlockPlugin);
+        auto singleBlock = RenderHelpers::makeNoiseBursts (renderLength);
+        RenderHelpers::render (singleBlockPlugin, singleBlock, renderLength);
+
+        PluginProcessor randomBlocksPlugin;
+        setUp (randomBlocksPlugin);
+        auto randomBlocks = RenderHelpers::makeNoiseBursts (renderLength);
+        juce::Random random (1234);
+        RenderHelpers::render (randomBlocksPlugin, randomBlocks, maxBlockSize, [&random]() { return 1 + random.nextInt (maxBlockSize); });
+
+        CHECK (RenderHelpers::getPeakDifferenceDecibels (singleBlock, randomBlocks) <= tolerance);
+    }
+}
+
+TEST_CASE ("Block size invariance", "[block-size]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    SECTION ("default state")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor&) {});
+    }
+
+    SECTION ("delay shorter than a block")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            RenderHelpers::setParameter (plugin.getApvts(), "Delay Time", 3.0f);
+            plugin.getApvts().getParameter ("Delay Feedback")->setValueNotifyingHost (0.8f);
+        });
+    }
+
+    SECTION ("modulated delay")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            auto& apvts = plugin.getApvts();
+            RenderHelpers::setParameter (apvts, "Delay Time", 12.0f);
+            apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (0.6f);
+            RenderHelpers::setParameter (apvts, "Delay Mod Depth", 5.0f);
+            RenderHelpers::setParameter (apvts, "Delay Mod Rate", 2.0f);
+            apvts.getParameter ("Delay Mod Shape")->setValueNotifyingHost (1.0f); // tape
+        }, modulatedToleranceDecibels);
+    }
+
+    SECTION ("reverse delay")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            auto& apvts = plugin.getApvts();
+            RenderHelpers::setParameter (apvts, "Delay Time", 150.0f);
+            RenderHelpers::setParameter (apvts, "Delay Mode", 1.0f);
+        });
+    }
+
+    SECTION ("granular delay with jitter")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            auto& apvts = plugin.getApvts();
+            RenderHelpers::setParameter (apvts, "Delay Time", 40.0f);
+            apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (0.5f);
+            apvts.getParameter ("Delay Mode")->setValueNotifyingHost (1.0f); // granular
+            apvts.getParameter ("Delay Grain Density")->setValueNotifyingHost (1.0f); // 32 grains
+            RenderHelpers::setParameter (apvts, "Delay Grain Pitch Jitter", 7.0f);
+            RenderHelpers::setParameter (apvts, "Delay Grain Position Jitter", 200.0f);
+        });
+    }
+
+    SECTION ("shimmer")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            auto& apvts = plugin.getApvts();
+            RenderHelpers::setParameter (apvts, "Delay Time", 80.0f);
+            apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (0.7f);
+            apvts.getParameter ("Delay Shimmer")->setValueNotifyingHost (0.5f);
+        });
+    }
+
+    SECTION ("ducking with lookahead")
+    {
+        checkBlockSizeInvariance ([] (PluginProcessor& plugin)
+        {
+            auto& apvts = plugin.getApvts();
+            RenderHelpers::setParameter (apvts, "Duck Depth", 18.0f);
+            apvts.getParameter ("Duck Lookahead")->setValueNotifyingHost (1.0f);
+        });
+    }
+
+    SECTION ("factory presets")
+    {
+        for (const auto& preset : RenderHelpers::getFactoryPresets())
+        {
+            INFO (preset.getFileName());
+            checkBlockSizeInvariance ([&preset] (PluginProcessor& plugin) { REQUIRE (RenderHelpers::applyPreset (plugin, preset)); });
+        }
+    }
+}
+
+// Offline, with long blocks, the delay's channels are processed on several threads.
+TEST_CASE ("Parallel rendering", "[block-size]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    constexpr auto blockSize = 2 * PluginProcessor::minParallelBlockSize;
+
+    auto renderOffline = [] (bool parallel)
+    {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getApvts();
+        RenderHelpers::setParameter (apvts, "Delay Time", 80.0f);
+        apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (0.7f);
+        RenderHelpers::setParameter (apvts, "Delay Mod Depth", 5.0f);
+        apvts.getParameter ("Delay Shimmer")->setValueNotifyingHost (0.5f);
+
+        plugin.setNonRealtime (true);
+        plugin.setParallelRendering (parallel);
+
+        auto audio = RenderHelpers::makeNoiseBursts (renderLength);
+        RenderHelpers::render (plugin, audio, blockSize);
+        return audio;
+    };
+
+    // Each channel goes through the same operations, whichever thread runs them.
+    CHECK (RenderHelpers::isBitExact (renderOffline (false), renderOffline (true)));
+}
@@ -0,0 +1,57 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+/* Frozen, the delay loops over its last delay time and ignores the input:
+ * fully wet, with the reverb passing its input through, the output repeats
+ * itself exactly every delay time.
+ */
+namespace
+{
+    juce::AudioBuffer<float> makeNoise (int numSamples, juce::int64 seed)
+    {
+        juce::AudioBuffer<float> buffer (RenderHelpers::numChannels, numSamples);
+        juce::Random random (seed);
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < numSamples; ++sample)
+                buffer.setSample (channel, sample, 0.5f * (2.0f * random.nextFloat() - 1.0f));
+        return buffer;
+    }
+}
+
+TEST_CASE ("Delay freeze", "[delay-freeze]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    RenderHelpers::setParameter (apvts, "Delay Time", 100.0f);
+    RenderHelpers::setParameter (apvts, "Delay Feedback", 0.5f);
+    RenderHelpers::setParameter (apvts, "Plugin Dry Wet", 1.0f);
+    RenderHelpers::setParameter (apvts, "Reverb Wet", 0.0f);
+    RenderHelpers::setParameter (apvts, "Reverb Dry", 1.0f);
+
+    constexpr int blockSize = 480;
+    const auto loopLength = static_cast<int> (0.1 * RenderHelpers::sampleRate);
+
+    plugin.setRateAndBufferSizeDetails (RenderHelpers::sampleRate, blockSize);
+    plugin.prepareToPlay (RenderHelpers::sampleRate, blockSize);
+
+    auto before = makeNoise (static_cast<int> (RenderHelpers::sampleRate), 1);
+    RenderHelpers::processInBlocks (plugin, before, blockSize);
+
+    RenderHelpers::setParameter (apvts, "Delay Freeze", 1.0f);
+    auto frozen = makeNoise (3 * loopLength, 2); // different noise, to be ignored
+    RenderHelpers::processInBlocks (plugin, frozen, blockSize);
+
+    // The first period lets the smoothed gains settle.
+    auto peakDifference = 0.0f;
+    for (int channel = 0; channel < frozen.getNumChannels(); ++channel)
+        for (int sample = loopLength; sample < 2 * loopLength; ++sample)
+            peakDifference = juce::jmax (peakDifference, std::abs (frozen.getSample (channel, sample) - frozen.getSample (channel, sample + loopLength)));
+
+    CHECK (peakDifference < 1.0e-5f);
+    CHECK (frozen.getMagnitude (2 * loopLength, loopLength) > 0.01f);
+
+    plugin.releaseResources();
+}
@@ -0,0 +1,148 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <optional>
+
+/* Golden-file regression tests.
+ *
+ * Every factory preset (Resources/PRESET_*.xml) renders an impulse, a sine
+ * sweep and noise bursts. The outputs are compared with the reference renders
+ * stored in tests/golden/, as 32 bit float WAV files.
+ *
+ * References are only written when DEEEEEE_RECORD_GOLDEN is set, e.g. after
+ * an intended change of the sound:
+ *     DEEEEEE_RECORD_GOLDEN=1 ./Tests "[golden]"
+ * Outside of that, a missing reference is a failure: a render that
+ * nothing is compared with checks nothing.
+ *
+ * Both are hidden from the default run until the references are committed
+ * in tests/golden/, ask for them with "[golden]" or "[golden-exact]".
+ *
+ * [golden] allows a residual up to toleranceDecibels, so that optimisations
+ * reordering floating point operations (SIMD, fast-math) pass. [golden-exact]
+ * asks for the very same bits, to check refactorings that shouldn't
+ * change a single operation.
+ */
+namespace
+{
+    constexpr int renderLength = static_cast<int> (3.0 * RenderHelpers::sampleRate);
+    constexpr int blockSize = 512;
+    constexpr float toleranceDecibels = -90.0f;
+
+    struct TestSignal
+    {
+        const char* name;
+        juce::AudioBuffer<float> (*make) (int);
+    };
+
+    const TestSignal testSignals[] = {
+        { "impulse", RenderHelpers::makeImpulse },
+        { "sweep", RenderHelpers::makeSweep },
+        { "noise", RenderHelpers::makeNoiseBursts },
+    };
+
+    juce::File getGoldenFile (const juce::File& preset, const TestSignal& signal)
+    {
+        return RenderHelpers::getRepositoryRoot()
+            .getChildFile ("tests")
+            .getChildFile ("golden")
+            .getChildFile (preset.getFileNameWithoutExtension() + "-" + signal.name + ".wav");
+    }
+
+    bool writeGolden (const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        file.getParentDirectory().createDirectory();
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        auto* stream = new juce::FileOutputStream (file);
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream, RenderHelpers::sampleRate, static_cast<unsigned int> (audio.getNumChannels()), 32, {}, 0));
+        if (writer == nullptr)
+        {
+            delete stream;
+            return false;
+        }
+
+        return writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    }
+
+    std::optional<juce::AudioBuffer<float>> readGolden (const juce::File& file)
+    {
+        if (!file.existsAsFile())
+            return std::nullopt;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader (wav.createReaderFor (file.createInputStream().release(), true));
+        if (reader == nullptr)
+            return std::nullopt;
+
+        juce::AudioBuffer<float> audio (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&audio, 0, audio.getNumSamples(), 0, true, true);
+        return audio;
+    }
+
+    /**
+     * @brief Renders every preset and signal and hands the result
+     *        and its reference (or nothing) over to compare.
+     */
+    void forEachGoldenRender (const std::function<void (const juce::AudioBuffer<float>& rendered, const juce::AudioBuffer<float>& golden)>& compare)
+    {
+        auto gui = juce::ScopedJuceInitialiser_GUI {};
+        const auto isRecording = juce::SystemStats::getEnvironmentVariable ("DEEEEEE_RECORD_GOLDEN", {}).isNotEmpty();
+
+        const auto presets = RenderHelpers::getFactoryPresets();
+        REQUIRE (!presets.isEmpty());
+
+        for (const auto& preset : presets)
+        {
+            for (const auto& signal : testSignals)
+            {
+                DYNAMIC_SECTION (preset.getFileNameWithoutExtension() << " - " << signal.name)
+                {
+                    PluginProcessor plugin;
+                    REQUIRE (RenderHelpers::applyPreset (plugin, preset));
+
+                    auto audio = signal.make (renderLength);
+                    RenderHelpers::render (plugin, audio, blockSize);
+
+                    const auto goldenFile = getGoldenFile (preset, signal);
+                    if (isRecording)
+                    {
+                        REQUIRE (writeGolden (goldenFile, audio));
+                        continue;
+                    }
+
+                    auto golden = readGolden (goldenFile);
+                    if (!golden.has_value())
+                    {
+                        FAIL_CHECK ("No reference " << goldenFile.getFullPathName() << ", record it with DEEEEEE_RECORD_GOLDEN=1");
+                        continue;
+                    }
+
+                    REQUIRE (golden->getNumChannels() == audio.getNumChannels());
+                    REQUIRE (golden->getNumSamples() == audio.getNumSamples());
+                    compare (audio, *golden);
+                }
+            }
+        }
+
+        if (isRecording)
+            SKIP ("Golden renders recorded in tests/golden/");
+    }
+}
+
+TEST_CASE ("Golden renders within tolerance", "[.golden]")
+{
+    forEachGoldenRender ([] (const juce::AudioBuffer<float>& rendered, const juce::AudioBuffer<float>& golden)
+    {
+        CHECK (RenderHelpers::getPeakDifferenceDecibels (rendered, golden) <= toleranceDecibels);
+    });
+}
+
+TEST_CASE ("Golden renders bit-exact", "[.golden-exact]")
+{
+    forEachGoldenRender ([] (const juce::AudioBuffer<float>& rendered, const juce::AudioBuffer<float>& golden)
+    {
+        CHECK (RenderHelpers::isBitExact (rendered, golden));
+    });
+}
@@ -0,0 +1,141 @@
+#include "helpers/render_helpers.h"
+#include <MidSide/MidSide.hpp>
+#include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+/* The stereo stage on its own, on the plugin's parameters: neutral it's
+ * the identity, at width 0 it's mono, the mid and side gains only
+ * scale their own channel, and bass mono empties the side of its lows.
+ */
+namespace
+{
+    constexpr int numSamples = 4096;
+
+    // Left and right made of a different noise, so mid and side both carry signal.
+    juce::AudioBuffer<float> makeStereoNoise()
+    {
+        juce::AudioBuffer<float> buffer (RenderHelpers::numChannels, numSamples);
+        juce::Random random (7);
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int sample = 0; sample < numSamples; ++sample)
+                buffer.setSample (channel, sample, 0.5f * (2.0f * random.nextFloat() - 1.0f));
+        return buffer;
+    }
+
+    void process (MidSide& midSide, juce::AudioBuffer<float>& audio)
+    {
+        juce::dsp::AudioBlock<float> block (audio);
+        juce::dsp::ProcessContextReplacing<float> context (block);
+        midSide.process (context);
+    }
+}
+
+TEST_CASE ("Mid/side stage", "[midside]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    MidSide midSide (apvts);
+    const auto input = makeStereoNoise();
+    auto audio = input;
+
+    // Parameters set before prepare() are there from the first sample.
+    auto prepare = [&]()
+    {
+        midSide.prepare ({ RenderHelpers::sampleRate, static_cast<juce::uint32> (numSamples), static_cast<juce::uint32> (RenderHelpers::numChannels) });
+        audio.makeCopyOf (input);
+    };
+
+    SECTION ("Neutral is the identity")
+    {
+        prepare();
+        process (midSide, audio);
+        CHECK (RenderHelpers::isBitExact (audio, input));
+    }
+
+    SECTION ("Width 0 is mono")
+    {
+        RenderHelpers::setParameter (apvts, "Stereo Width", 0.0f);
+        prepare();
+        process (midSide, audio);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            CHECK (audio.getSample (0, sample) == Catch::Approx (audio.getSample (1, sample)).margin (1.0e-6));
+            CHECK (audio.getSample (0, sample) == Catch::Approx (0.5f * (input.getSample (0, sample) + input.getSample (1, sample))).margin (1.0e-6));
+        }
+    }
+
+    SECTION ("Mid and side gains")
+    {
+        RenderHelpers::setParameter (apvts, "Mid Gain", 0.5f);
+        RenderHelpers::setParameter (apvts, "Side Gain", 1.5f);
+        prepare();
+        process (midSide, audio);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto mid = 0.5f * (input.getSample (0, sample) + input.getSample (1, sample));
+            const auto side = 0.5f * (input.getSample (0, sample) - input.getSample (1, sample));
+            CHECK (audio.getSample (0, sample) == Catch::Approx (0.5f * mid + 1.5f * side).margin (1.0e-6));
+            CHECK (audio.getSample (1, sample) == Catch::Approx (0.5f * mid - 1.5f * side).margin (1.0e-6));
+        }
+    }
+
+    SECTION ("Bass mono takes the lows out of the side")
+    {
+        RenderHelpers::setParameter (apvts, "Bass Mono Frequency", 200.0f);
+        prepare();
+
+        // Only side, a low and a high sine: the low one goes, the high one stays.
+        auto sideLevel = [&] (float frequency)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                const auto x = std::sin (juce::MathConstants<float>::twoPi * frequency * static_cast<float> (sample) / static_cast<float> (RenderHelpers::sampleRate));
+                audio.setSample (0, sample, x);
+                audio.setSample (1, sample, -x);
+            }
+
+            midSide.reset();
+            process (midSide, audio);
+
+            // Without mid, left is the side. Past the filter's settling.
+            return audio.getRMSLevel (0, numSamples / 2, numSamples / 2);
+        };
+
+        // 24dB/oct, three octaves below and four and a half above.
+        CHECK (sideLevel (25.0f) < 0.01f);
+        CHECK (sideLevel (4000.0f) == Catch::Approx (std::sqrt (0.5f)).margin (0.01));
+    }
+
+    SECTION ("Width changes ramp sample by sample")
+    {
+        prepare();
+
+        // Only side: the output is the side gain.
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            audio.setSample (0, sample, 1.0f);
+            audio.setSample (1, sample, -1.0f);
+        }
+
+        RenderHelpers::setParameter (apvts, "Stereo Width", 0.0f);
+        midSide.setParameters (midSide.dumpParametersFromAPVTS());
+        process (midSide, audio);
+
+        // 20ms at 48kHz, a step of 1/960 every sample, no staircase.
+        const auto rampLength = static_cast<int> (0.02 * RenderHelpers::sampleRate);
+        for (int sample = 1; sample < rampLength; ++sample)
+        {
+            const auto step = audio.getSample (0, sample - 1) - audio.getSample (0, sample);
+            CHECK (step > 0.0f);
+            CHECK (step < 2.0f / static_cast<float> (rampLength));
+        }
+
+        CHECK (audio.getSample (0, numSamples - 1) == Catch::Approx (0.0f).margin (1.0e-6));
+    }
+}
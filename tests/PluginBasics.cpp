@@ -1,5 +1,6 @@
 #include "helpers/test_helpers.h"
 #include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
@@ -24,6 +25,62 @@ TEST_CASE ("Plugin instance", "[instance]")
     }
 }
 
+TEST_CASE ("Ducking lookahead latency", "[instance]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor testPlugin;
+
+    CHECK (testPlugin.getLatencySamples() == 0);
+
+    testPlugin.getApvts().getParameter ("Duck Lookahead")->setValueNotifyingHost (1.0f);
+    testPlugin.setRateAndBufferSizeDetails (48000.0, 512);
+    testPlugin.prepareToPlay (48000.0, 512);
+
+    CHECK (testPlugin.getLatencySamples() == juce::roundToInt (Ducker::lookaheadSeconds * 48000.0));
+}
+
+TEST_CASE ("Limiter latency", "[instance]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor testPlugin;
+
+    // Added to the ducker's
+    testPlugin.getApvts().getParameter ("Limiter")->setValueNotifyingHost (1.0f);
+    testPlugin.getApvts().getParameter ("Duck Lookahead")->setValueNotifyingHost (1.0f);
+    testPlugin.setRateAndBufferSizeDetails (48000.0, 512);
+    testPlugin.prepareToPlay (48000.0, 512);
+
+    CHECK (testPlugin.getLatencySamples() == juce::roundToInt (Ducker::lookaheadSeconds * 48000.0) + TruePeakLimiter::getLatencyInSamples (48000.0));
+}
+
+TEST_CASE ("Dry signal lines up with the lookahead", "[instance]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor testPlugin;
+    auto& apvts = testPlugin.getApvts();
+
+    // Fully dry, at unity.
+    apvts.getParameter ("Plugin Dry Wet")->setValueNotifyingHost (0.0f);
+    apvts.getParameter ("Output Level")->setValueNotifyingHost (1.0f);
+    apvts.getParameter ("Duck Lookahead")->setValueNotifyingHost (1.0f);
+
+    juce::AudioBuffer<float> buffer (2, 512);
+    buffer.clear();
+    buffer.setSample (0, 0, 1.0f);
+    buffer.setSample (1, 0, 1.0f);
+
+    testPlugin.setRateAndBufferSizeDetails (48000.0, 512);
+    testPlugin.prepareToPlay (48000.0, 512);
+    juce::MidiBuffer midi;
+    testPlugin.processBlock (buffer, midi);
+
+    const auto latency = juce::roundToInt (Ducker::lookaheadSeconds * 48000.0);
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        CHECK (buffer.getMagnitude (channel, 0, latency) < 1.0e-3f);
+        CHECK (buffer.getSample (channel, latency) == Catch::Approx (1.0f).margin (1.0e-3));
+    }
+}
 
 #ifdef PAMPLEJUCE_IPP
     #include <ipp.h>
@@ -0,0 +1,72 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+/* Hosts call prepareToPlay() again whenever a setting changes, without
+ * releaseResources() in between: what the delay holds is carried over,
+ * resampled to the new rate, and comes out as late as it would have.
+ */
+TEST_CASE ("Delay carried over a sample rate change", "[prepare]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    RenderHelpers::setParameter (apvts, "Delay Time", 100.0f);
+    RenderHelpers::setParameter (apvts, "Plugin Dry Wet", 1.0f);
+    RenderHelpers::setParameter (apvts, "Reverb Wet", 0.0f);
+    RenderHelpers::setParameter (apvts, "Reverb Dry", 1.0f);
+
+    constexpr int blockSize = 480;
+    constexpr double firstRate = 48000.0, secondRate = 96000.0;
+
+    // An impulse, then 50ms at the first rate.
+    plugin.setRateAndBufferSizeDetails (firstRate, blockSize);
+    plugin.prepareToPlay (firstRate, blockSize);
+
+    juce::AudioBuffer<float> before (RenderHelpers::numChannels, static_cast<int> (0.05 * firstRate));
+    before.clear();
+    for (int channel = 0; channel < before.getNumChannels(); ++channel)
+        before.setSample (channel, 0, 1.0f);
+    RenderHelpers::processInBlocks (plugin, before, blockSize);
+
+    // The echo is due 50ms into the second rate.
+    plugin.setRateAndBufferSizeDetails (secondRate, blockSize);
+    plugin.prepareToPlay (secondRate, blockSize);
+
+    juce::AudioBuffer<float> after (RenderHelpers::numChannels, static_cast<int> (0.1 * secondRate));
+    after.clear();
+    RenderHelpers::processInBlocks (plugin, after, blockSize);
+
+    const auto expected = static_cast<int> (0.05 * secondRate) + plugin.getLatencySamples();
+    for (int channel = 0; channel < after.getNumChannels(); ++channel)
+    {
+        const auto* samples = after.getReadPointer (channel);
+        int peak = 0;
+        for (int sample = 1; sample < after.getNumSamples(); ++sample)
+            if (std::abs (samples[sample]) > std::abs (samples[peak]))
+                peak = sample;
+
+        CHECK (std::abs (peak - expected) <= 2);
+        CHECK (std::abs (samples[peak]) > 0.01f);
+    }
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Released, prepareToPlay() starts from silence", "[prepare]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+
+    auto noise = RenderHelpers::makeNoiseBursts (static_cast<int> (RenderHelpers::sampleRate));
+    RenderHelpers::render (plugin, noise, 512);
+
+    // render() released the plugin, the delay and the reverb were cleared.
+    juce::AudioBuffer<float> silence (RenderHelpers::numChannels, static_cast<int> (RenderHelpers::sampleRate));
+    silence.clear();
+    RenderHelpers::render (plugin, silence, 512);
+
+    CHECK (silence.getMagnitude (0, silence.getNumSamples()) == 0.0f);
+}
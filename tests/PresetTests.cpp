@@ -0,0 +1,306 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <Preset/PresetBundle.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+/* What a preset, or the plugin state, carries over: saving and
+ * restoring gives back the same settings.
+ */
+TEST_CASE ("Morph slots are part of the plugin state", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    Preset presetA, presetB;
+    presetA.delayTime = 100;
+    presetB.delayTime = 900;
+
+    juce::MemoryBlock state;
+    {
+        PluginProcessor plugin;
+        plugin.getPresetMorph().setSlot (PresetMorph::Slot::a, presetA);
+        plugin.getPresetMorph().setSlot (PresetMorph::Slot::b, presetB);
+        plugin.getStateInformation (state);
+    }
+
+    PluginProcessor restored;
+    restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+    auto& morph = restored.getPresetMorph();
+    CHECK (morph.hasSlot (PresetMorph::Slot::a));
+    CHECK (morph.hasSlot (PresetMorph::Slot::b));
+
+    // Picked up by the audio thread, halfway is halfway between the two.
+    REQUIRE (morph.updateFromMessageThread());
+    CHECK (morph.getValuesAt (0.5f).delay.timeMs == 500);
+
+    // A state without slots empties them.
+    PluginProcessor empty;
+    empty.getStateInformation (state);
+    restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+    CHECK_FALSE (morph.hasSlot (PresetMorph::Slot::a));
+    CHECK_FALSE (morph.updateFromMessageThread());
+}
+
+TEST_CASE ("Morphing the delay time doesn't click", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+
+    // Fully wet, only the delay time differs.
+    Preset presetA;
+    presetA.delayTime = 100;
+    presetA.delayFeedback = 0.1f;
+    presetA.reverbDry = 1.0f;
+    presetA.reverbWidth = 1.0f;
+    presetA.pluginDryWet = 1.0f;
+    presetA.pluginLevel = 1.0f;
+    presetA.pluginGain = 1.0f;
+
+    auto presetB = presetA;
+    presetB.delayTime = 600;
+
+    plugin.getPresetMorph().setSlot (PresetMorph::Slot::a, presetA);
+    plugin.getPresetMorph().setSlot (PresetMorph::Slot::b, presetB);
+    auto* morphParameter = plugin.getApvts().getParameter ("Preset Morph");
+    morphParameter->setValueNotifyingHost (0.0f);
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480;
+    plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    plugin.prepareToPlay (sampleRate, blockSize);
+
+    // A steady sine: a jump of the read head is a step in the output.
+    juce::AudioBuffer<float> block (2, blockSize);
+    juce::MidiBuffer midi;
+    int sampleIndex = 0;
+    auto processNextBlock = [&]()
+    {
+        for (int i = 0; i < blockSize; ++i, ++sampleIndex)
+            for (int channel = 0; channel < 2; ++channel)
+                block.setSample (channel, i, 0.25f * std::sin (juce::MathConstants<float>::twoPi * 200.0f * static_cast<float> (sampleIndex) / static_cast<float> (sampleRate)));
+
+        plugin.processBlock (block, midi);
+    };
+
+    for (int i = 0; i < 100; ++i)
+        processNextBlock();
+
+    // From A to B over a second, a new delay time every block.
+    auto previous = block.getSample (0, blockSize - 1);
+    auto largestStep = 0.0f;
+    for (int i = 1; i <= 100; ++i)
+    {
+        morphParameter->setValueNotifyingHost (static_cast<float> (i) / 100.0f);
+        processNextBlock();
+
+        for (int sample = 0; sample < blockSize; ++sample)
+        {
+            largestStep = juce::jmax (largestStep, std::abs (block.getSample (0, sample) - previous));
+            previous = block.getSample (0, sample);
+        }
+    }
+
+    // The sine moves by less than 0.02 per sample, through the reverb's dry gain and with the echoes.
+    CHECK (largestStep < 0.05f);
+}
+
+TEST_CASE ("The morph covers the modulation, grains, shimmer and ducking", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+
+    Preset presetA, presetB;
+    presetA.delayModDepth = 2.0f;
+    presetB.delayModDepth = 6.0f;
+    presetB.delayGrainDensity = 8;
+    presetB.delayShimmer = 0.5f;
+    presetB.duckDepth = 24.0f;
+    presetB.delayMode = 2;
+    presetB.duckLookahead = true;
+
+    auto& morph = plugin.getPresetMorph();
+    morph.setSlot (PresetMorph::Slot::a, presetA);
+    morph.setSlot (PresetMorph::Slot::b, presetB);
+    REQUIRE (morph.updateFromMessageThread());
+
+    // Continuous values are halfway.
+    const auto halfway = morph.getValuesAt (0.5f);
+    CHECK (halfway.delay.modDepthMs == Catch::Approx (4.0f));
+    CHECK (halfway.delay.grainDensity == 6);
+    CHECK (halfway.delay.shimmer == Catch::Approx (0.25f));
+    CHECK (halfway.ducker.depth == Catch::Approx (12.0f));
+
+    // Discrete ones are A's up to the midpoint, B's from there.
+    const auto nearA = morph.getValuesAt (0.4f);
+    CHECK (nearA.delay.mode == 0);
+    CHECK_FALSE (nearA.ducker.lookahead);
+    CHECK (halfway.delay.mode == 2);
+    CHECK (halfway.ducker.lookahead);
+}
+
+TEST_CASE ("Bundle imports stay in the presets folder", "[preset]")
+{
+    auto temporaryDirectory = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("bundle", {});
+    const auto sourceDirectory = temporaryDirectory.getChildFile ("source");
+    const auto presetsDirectory = temporaryDirectory.getChildFile ("nested").getChildFile ("presets");
+    REQUIRE (sourceDirectory.createDirectory());
+    REQUIRE (presetsDirectory.createDirectory());
+
+    // Names a malicious or sloppy bundle could carry.
+    juce::Array<juce::File> presetFiles;
+    for (auto name : { "../../Escape", "Existing", "" })
+    {
+        Preset preset;
+        preset.presetName = name;
+        auto file = sourceDirectory.getNonexistentChildFile ("preset", ".xml");
+        REQUIRE (preset.toXml()->writeTo (file));
+        presetFiles.add (file);
+    }
+
+    const auto bundleFile = temporaryDirectory.getChildFile ("presets.deeeeee");
+    REQUIRE (PresetBundle::write (presetFiles, bundleFile, nullptr));
+
+    const auto existingFile = presetsDirectory.getChildFile ("Existing.xml");
+    REQUIRE (existingFile.replaceWithText ("keep me"));
+
+    juce::Array<juce::File> writtenFiles;
+    CHECK (PresetBundle::read (bundleFile, presetsDirectory, nullptr, writtenFiles));
+    CHECK (writtenFiles.size() == 3);
+
+    for (const auto& file : writtenFiles)
+        CHECK (file.isAChildOf (presetsDirectory));
+
+    CHECK_FALSE (temporaryDirectory.getChildFile ("Escape.xml").exists());
+    CHECK (existingFile.loadFileAsString() == "keep me");
+
+    // An empty bundle is a valid bundle.
+    REQUIRE (PresetBundle::write ({}, bundleFile, nullptr));
+    writtenFiles.clear();
+    CHECK (PresetBundle::read (bundleFile, presetsDirectory, nullptr, writtenFiles));
+    CHECK (writtenFiles.isEmpty());
+
+    temporaryDirectory.deleteRecursively();
+}
+
+TEST_CASE ("Loading a preset only changes what it stores", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    auto getParameter = [&apvts] (const juce::String& parameterID)
+    {
+        return apvts.getRawParameterValue (parameterID)->load();
+    };
+
+    // Through the file format and back.
+    Preset saved;
+    saved.delayTime = 250;
+    saved.delayModRate = 2.0f;
+    saved.delayModDepth = 3.0f;
+    saved.delayModShape = 1;
+    saved.delayModStereo = 45.0f;
+    saved.delayMode = 2;
+    saved.delayGrainSize = 200.0f;
+    saved.delayGrainDensity = 6;
+    saved.delayShimmer = 0.4f;
+    saved.delayShimmerPitch = 1;
+    saved.duckDepth = 12.0f;
+    saved.duckLookahead = true;
+    saved.duckSource = 1;
+    saved.stereoWidth = 0.5f;
+    saved.bassMonoFrequency = 120.0f;
+    const auto preset = Preset::fromXml (*saved.toXml());
+
+    RenderHelpers::setParameter (apvts, "Stereo Width", 1.5f);
+    preset.applyTo (apvts);
+
+    CHECK (juce::roundToInt (getParameter ("Delay Time")) == 250);
+    CHECK (getParameter ("Delay Mod Rate") == Catch::Approx (2.0f).margin (1.0e-4));
+    CHECK (getParameter ("Delay Mod Depth") == Catch::Approx (3.0f).margin (1.0e-4));
+    CHECK (juce::roundToInt (getParameter ("Delay Mod Shape")) == 1);
+    CHECK (getParameter ("Delay Mod Stereo") == Catch::Approx (45.0f).margin (1.0e-4));
+    CHECK (juce::roundToInt (getParameter ("Delay Mode")) == 2);
+    CHECK (getParameter ("Delay Grain Size") == Catch::Approx (200.0f).margin (1.0e-4));
+    CHECK (juce::roundToInt (getParameter ("Delay Grain Density")) == 6);
+    CHECK (getParameter ("Delay Shimmer") == Catch::Approx (0.4f).margin (1.0e-4));
+    CHECK (juce::roundToInt (getParameter ("Delay Shimmer Pitch")) == 1);
+    CHECK (getParameter ("Duck Depth") == Catch::Approx (12.0f).margin (1.0e-4));
+    CHECK (getParameter ("Duck Lookahead") == 1.0f);
+    CHECK (juce::roundToInt (getParameter ("Duck Source")) == 1);
+
+    CHECK (getParameter ("Stereo Width") == Catch::Approx (0.5f).margin (1.0e-4));
+    CHECK (getParameter ("Bass Mono Frequency") == Catch::Approx (120.0f).margin (1.0e-4));
+
+    // A preset saved before the modulation existed has none.
+    auto oldFile = saved.toXml();
+    auto* parameters = oldFile->getChildByName ("PARAMETERS");
+    parameters->removeChildElement (parameters->getChildByName ("MODULATION"), true);
+    parameters->removeChildElement (parameters->getChildByName ("MIDSIDE"), true);
+    Preset::fromXml (*oldFile).applyTo (apvts);
+
+    CHECK (getParameter ("Delay Mod Depth") == 0.0f);
+    CHECK (getParameter ("Stereo Width") == Catch::Approx (1.0f));
+    CHECK (getParameter ("Bass Mono Frequency") == Catch::Approx (20.0f));
+}
+
+TEST_CASE ("Loading a preset doesn't let go of the freeze", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    apvts.getParameter ("Delay Freeze")->setValueNotifyingHost (1.0f);
+
+    Preset preset;
+    preset.delayTime = 300;
+    Preset::fromXml (*preset.toXml()).applyTo (apvts);
+
+    CHECK (apvts.getRawParameterValue ("Delay Freeze")->load() == 1.0f);
+    CHECK_FALSE (preset.toXml()->getChildByName ("PARAMETERS")->getChildByName ("DELAY")->hasAttribute ("Freeze"));
+}
+
+TEST_CASE ("Loading a preset keeps the limiter as it is", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    RenderHelpers::setParameter (apvts, "Limiter", 1.0f);
+    RenderHelpers::setParameter (apvts, "Limiter Ceiling", -6.0f);
+
+    Preset preset;
+    preset.pluginGain = 1.5f;
+    Preset::fromXml (*preset.toXml()).applyTo (apvts);
+
+    // It protects the monitors, a preset mustn't turn it off.
+    CHECK (apvts.getRawParameterValue ("Limiter")->load() == 1.0f);
+    CHECK (apvts.getRawParameterValue ("Limiter Ceiling")->load() == Catch::Approx (-6.0f).margin (1.0e-4));
+}
+
+TEST_CASE ("The OpenGL switch survives preset loads and older sessions", "[preset]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+    apvts.state.setProperty (PluginProcessor::useOpenGLProperty, true, nullptr);
+
+    Preset preset;
+    preset.delayTime = 700;
+    Preset::fromXml (*preset.toXml()).applyTo (apvts);
+    CHECK (static_cast<bool> (apvts.state.getProperty (PluginProcessor::useOpenGLProperty)));
+
+    // A session from before the switch.
+    juce::MemoryBlock state;
+    {
+        PluginProcessor older;
+        older.getApvts().state.removeProperty (PluginProcessor::useOpenGLProperty, nullptr);
+        older.getStateInformation (state);
+    }
+
+    plugin.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+    CHECK (static_cast<bool> (plugin.getApvts().state.getProperty (PluginProcessor::useOpenGLProperty)));
+}
@@ -0,0 +1,142 @@
+#include "helpers/render_helpers.h"
+#include <Health/HealthCheck.hpp>
+#include <PluginProcessor.h>
+#include <array>
+#include <bit>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <limits>
+
+/* A single bad block mustn't poison the instance: whatever got a NaN
+ * or an infinity is cleared, and the output is clean again right after.
+ */
+namespace
+{
+    // Made from their bits, fast-math could fold std::numeric_limits' ones away.
+    const auto nan = std::bit_cast<float> (std::uint32_t { 0x7fc00000 });
+    const auto infinity = std::bit_cast<float> (std::uint32_t { 0x7f800000 });
+}
+
+/* Befriended by PluginProcessor and Delay, so that the shipped plugin has
+ * no way in. Puts a NaN inside a feedback loop, where the input check can't
+ * stop it. Not while processing.
+ */
+struct StateRecoveryTestAccess
+{
+    // Overwrites the whole delay line, the way a fault inside the loop would.
+    static void poisonDelay (PluginProcessor& plugin)
+    {
+        auto& delayBuffer = plugin.delay.mDelayBuffer;
+        for (int channel = 0; channel < delayBuffer.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::fill (delayBuffer.getWritePointer (channel), nan, delayBuffer.getNumSamples());
+    }
+
+    // Through the reverb's own input, it ends up in every comb and allpass.
+    static void poisonReverb (PluginProcessor& plugin)
+    {
+        float left = nan, right = nan;
+        float* channels[] = { &left, &right };
+        juce::dsp::AudioBlock<float> block (channels, 2, 1);
+        juce::dsp::ProcessContextReplacing<float> context (block);
+        plugin.reverb.process (context);
+    }
+};
+
+TEST_CASE ("Health checks", "[health]")
+{
+    std::array<float, 37> samples {};
+    samples.fill (0.5f);
+
+    CHECK (HealthCheck::isHealthy (samples.data(), static_cast<int> (samples.size())));
+
+    samples[21] = -2000.0f;
+    CHECK_FALSE (HealthCheck::isHealthy (samples.data(), static_cast<int> (samples.size())));
+    CHECK (HealthCheck::isHealthy (samples.data(), static_cast<int> (samples.size()), 4000.0f));
+
+    samples[21] = infinity;
+    CHECK_FALSE (HealthCheck::isHealthy (samples.data(), static_cast<int> (samples.size()), std::numeric_limits<float>::max()));
+
+    samples[21] = -nan;
+    CHECK_FALSE (HealthCheck::isHealthy (samples.data(), static_cast<int> (samples.size()), std::numeric_limits<float>::max()));
+}
+
+TEST_CASE ("Recovery from a bad block", "[health]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    // Long feedback and a frozen reverb: both would keep a NaN forever.
+    apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (1.0f);
+    apvts.getParameter ("Delay Shimmer")->setValueNotifyingHost (0.5f);
+    apvts.getParameter ("Reverb Freeze")->setValueNotifyingHost (1.0f);
+
+    constexpr int blockSize = 512;
+    plugin.setRateAndBufferSizeDetails (RenderHelpers::sampleRate, blockSize);
+    plugin.prepareToPlay (RenderHelpers::sampleRate, blockSize);
+
+    auto audio = RenderHelpers::makeNoiseBursts (static_cast<int> (RenderHelpers::sampleRate));
+
+    juce::AudioBuffer<float> bad (RenderHelpers::numChannels, blockSize);
+    bad.clear();
+    bad.setSample (0, 10, nan);
+    bad.setSample (1, 20, infinity);
+    RenderHelpers::processInBlocks (plugin, bad, blockSize);
+
+    CHECK (plugin.getNumStateResets() > 0);
+
+    RenderHelpers::processInBlocks (plugin, audio, blockSize, [] (juce::AudioBuffer<float>& block)
+    {
+        REQUIRE (HealthCheck::isHealthy (juce::dsp::AudioBlock<float> (block)));
+    });
+}
+
+TEST_CASE ("Recovery from a fault inside the feedback loops", "[health]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    apvts.getParameter ("Delay Feedback")->setValueNotifyingHost (1.0f);
+    apvts.getParameter ("Reverb Freeze")->setValueNotifyingHost (1.0f);
+
+    constexpr int blockSize = 512;
+    plugin.setRateAndBufferSizeDetails (RenderHelpers::sampleRate, blockSize);
+    plugin.prepareToPlay (RenderHelpers::sampleRate, blockSize);
+
+    auto audio = RenderHelpers::makeNoiseBursts (static_cast<int> (RenderHelpers::sampleRate));
+
+    // Clean input all along: a reset can only come from the loop that was poisoned.
+    auto processAudio = [&]()
+    {
+        auto processed = audio;
+        auto peak = 0.0f;
+        RenderHelpers::processInBlocks (plugin, processed, blockSize, [&peak] (juce::AudioBuffer<float>& block)
+        {
+            REQUIRE (HealthCheck::isHealthy (juce::dsp::AudioBlock<float> (block)));
+            peak = juce::jmax (peak, block.getMagnitude (0, block.getNumSamples()));
+        });
+        return peak;
+    };
+
+    CHECK (processAudio() > 0.0f);
+    REQUIRE (plugin.getNumStateResets() == 0);
+
+    SECTION ("Delay")
+    {
+        StateRecoveryTestAccess::poisonDelay (plugin);
+
+        // The delay's check silences its output, the reverb never sees the NaN.
+        CHECK (processAudio() > 0.0f);
+        CHECK (plugin.getNumStateResets() == 1);
+    }
+
+    SECTION ("Reverb")
+    {
+        StateRecoveryTestAccess::poisonReverb (plugin);
+
+        // Frozen, the reverb would hold the NaN forever.
+        CHECK (processAudio() > 0.0f);
+        CHECK (plugin.getNumStateResets() == 1);
+    }
+}
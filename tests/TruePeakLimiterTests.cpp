@@ -0,0 +1,98 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+/* With the limiter on, nothing gets past the ceiling: not the gain at its
+ * highest, nor a feedback that runs away. The output is measured 4 times
+ * oversampled, where its true peaks are.
+ */
+namespace
+{
+    float getTruePeak (const juce::AudioBuffer<float>& audio)
+    {
+        juce::dsp::Oversampling<float> oversampling (static_cast<size_t> (audio.getNumChannels()), 2, juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true);
+        oversampling.initProcessing (static_cast<size_t> (audio.getNumSamples()));
+
+        const auto oversampled = oversampling.processSamplesUp (juce::dsp::AudioBlock<const float> (audio));
+        auto peak = 0.0f;
+        for (size_t channel = 0; channel < oversampled.getNumChannels(); ++channel)
+            for (size_t sample = 0; sample < oversampled.getNumSamples(); ++sample)
+                peak = juce::jmax (peak, std::abs (oversampled.getSample (static_cast<int> (channel), static_cast<int> (sample))));
+
+        return peak;
+    }
+
+    // The limiter estimates the peaks with 8 taps, the measure uses a much longer filter.
+    const auto truePeakMargin = juce::Decibels::decibelsToGain (0.25f);
+}
+
+TEST_CASE ("True-peak limiter", "[limiter]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    constexpr float ceilingDecibels = -3.0f;
+    RenderHelpers::setParameter (apvts, "Limiter", 1.0f);
+    RenderHelpers::setParameter (apvts, "Limiter Ceiling", ceilingDecibels);
+    RenderHelpers::setParameter (apvts, "Delay Time", 20.0f);
+    RenderHelpers::setParameter (apvts, "Delay Feedback", 1.0f);
+    RenderHelpers::setParameter (apvts, "Output Level", 1.0f);
+    RenderHelpers::setParameter (apvts, "Output Gain", 1.5f);
+
+    // A full scale sine near a quarter of the sample rate, its true peaks fall between samples.
+    constexpr int numSamples = static_cast<int> (RenderHelpers::sampleRate);
+    juce::AudioBuffer<float> audio (RenderHelpers::numChannels, numSamples);
+    for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+        for (int sample = 0; sample < numSamples; ++sample)
+            audio.setSample (channel, sample, std::sin (0.49f * juce::MathConstants<float>::pi * static_cast<float> (sample) + 0.8f));
+
+    RenderHelpers::render (plugin, audio, 512);
+
+    CHECK (plugin.getLatencySamples() == TruePeakLimiter::getLatencyInSamples (RenderHelpers::sampleRate));
+
+    const auto ceiling = juce::Decibels::decibelsToGain (ceilingDecibels);
+    CHECK (getTruePeak (audio) <= ceiling * truePeakMargin);
+}
+
+TEST_CASE ("True-peak limiter holds past the peak", "[limiter]")
+{
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    PluginProcessor plugin;
+    auto& apvts = plugin.getApvts();
+
+    constexpr float ceilingDecibels = -3.0f;
+    RenderHelpers::setParameter (apvts, "Limiter", 1.0f);
+    RenderHelpers::setParameter (apvts, "Limiter Ceiling", ceilingDecibels);
+
+    constexpr int numSamples = 4096, blockSize = 512, peakIndex = 1000;
+    TruePeakLimiter limiter (apvts);
+    limiter.prepare ({ RenderHelpers::sampleRate, static_cast<juce::uint32> (blockSize), static_cast<juce::uint32> (RenderHelpers::numChannels) });
+
+    // Two samples over the ceiling: the true peak is between them.
+    constexpr float level = 0.9f;
+    juce::AudioBuffer<float> audio (RenderHelpers::numChannels, numSamples);
+    audio.clear();
+    for (int channel = 0; channel < audio.getNumChannels(); ++channel)
+    {
+        audio.setSample (channel, peakIndex, level);
+        audio.setSample (channel, peakIndex + 1, level);
+    }
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        auto block = juce::dsp::AudioBlock<float> (audio).getSubBlock (static_cast<size_t> (start), static_cast<size_t> (blockSize));
+        juce::dsp::ProcessContextReplacing<float> context (block);
+        limiter.process (context);
+    }
+
+    // The sample after the peak is the other end of the points between them,
+    // it needs as much reduction as the peak itself.
+    const auto latency = TruePeakLimiter::getLatencyInSamples (RenderHelpers::sampleRate);
+    const auto gainAtPeak = audio.getSample (0, peakIndex + latency) / level;
+    const auto gainAfterPeak = audio.getSample (0, peakIndex + 1 + latency) / level;
+
+    CHECK (gainAtPeak < juce::Decibels::decibelsToGain (ceilingDecibels) / level);
+    CHECK (gainAfterPeak <= gainAtPeak * 1.0001f);
+    CHECK (getTruePeak (audio) <= juce::Decibels::decibelsToGain (ceilingDecibels) * truePeakMargin);
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <PluginProcessor.h>
+#include <Preset/Preset.hpp>
+#include <cstring>
+#include <functional>
+
+/* Helpers to render audio through PluginProcessor in tests.
+ *
+ * Every render starts from prepareToPlay() and ends with releaseResources(),
+ * so the next one resets the whole engine: two renders of the same preset
+ * and signal are the same.
+ */
+namespace RenderHelpers
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+
+    // The repository, found from this file rather than from the working directory.
+    [[maybe_unused]] inline juce::File getRepositoryRoot()
+    {
+        return juce::File (__FILE__).getParentDirectory().getParentDirectory().getParentDirectory();
+    }
+
+    [[maybe_unused]] inline juce::Array<juce::File> getFactoryPresets()
+    {
+        auto presets = getRepositoryRoot().getChildFile ("Resources").findChildFiles (juce::File::findFiles, false, "PRESET_*.xml");
+        presets.sort();
+        return presets;
+    }
+
+    /**
+     * @brief Applies the preset file to plugin, false if it can't be read.
+     */
+    [[maybe_unused]] inline bool applyPreset (PluginProcessor& plugin, const juce::File& presetFile)
+    {
+        auto element = juce::XmlDocument::parse (presetFile);
+        if (element == nullptr || !element->hasTagName ("PRESET"))
+            return false;
+
+        Preset::fromXml (*element).applyTo (plugin.getApvts());
+        return true;
+    }
+
+    /**
+     * @brief Sets a parameter from its plain value, like a host would.
+     */
+    [[maybe_unused]] inline void setParameter (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float plainValue)
+    {
+        auto* parameter = apvts.getParameter (parameterID);
+        jassert (parameter != nullptr);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (plainValue));
+    }
+
+    /**
+     * @brief Processes audio in place through an already prepared plugin,
+     *        in blocks of blockSize (the last one may be shorter). onBlock,
+     *        if any, sees every block right after it's processed.
+     */
+    [[maybe_unused]] inline void processInBlocks (PluginProcessor& plugin, juce::AudioBuffer<float>& audio, int blockSize,
+                                                  const std::function<void (juce::AudioBuffer<float>&)>& onBlock = {})
+    {
+        juce::MidiBuffer midi;
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize)
+        {
+            juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), audio.getNumChannels(), start, juce::jmin (blockSize, audio.getNumSamples() - start));
+            plugin.processBlock (block, midi);
+
+            if (onBlock)
+                onBlock (block);
+        }
+    }
+
+    /**
+     * @brief A single sample at full scale, then silence.
+     */
+    [[maybe_unused]] inline juce::AudioBuffer<float> makeImpulse (int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, numSamples);
+        buffer.clear();
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.setSample (channel, 0, 1.0f);
+        return buffer;
+    }
+
+    /**
+     * @brief Exponential sine sweep from 20Hz to 20kHz over the first
+     *        half of the buffer, then silence for the tails.
+     */
+    [[maybe_unused]] inline juce::AudioBuffer<float> makeSweep (int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, numSamples);
+        buffer.clear();
+
+        const auto sweepLength = numSamples / 2;
+        const auto duration = static_cast<double> (sweepLength) / sampleRate;
+        const auto ratio = std::log (20000.0 / 20.0);
+
+        for (int sample = 0; sample < sweepLength; ++sample)
+        {
+            const auto time = static_cast<double> (sample) / sampleRate;
+            const auto phase = juce::MathConstants<double>::twoPi * 20.0 * duration / ratio * (std::exp (time / duration * ratio) - 1.0);
+            const auto value = static_cast<float> (0.5 * std::sin (phase));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.setSample (channel, sample, value);
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief Four bursts of 50ms of seeded white noise, a different one per channel.
+     */
+    [[maybe_unused]] inline juce::AudioBuffer<float> makeNoiseBursts (int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, numSamples);
+        buffer.clear();
+
+        juce::Random random (42);
+        const auto burstLength = static_cast<int> (0.05 * sampleRate);
+        const auto period = numSamples / 8;
+
+        for (int burst = 0; burst < 4; ++burst)
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int sample = burst * period; sample < juce::jmin (numSamples, burst * period + burstLength); ++sample)
+                    buffer.setSample (channel, sample, 0.5f * (2.0f * random.nextFloat() - 1.0f));
+
+        return buffer;
+    }
+
+    /**
+     * @brief Processes audio in place through plugin, in blocks whose
+     *        sizes are given by nextBlockSize (never above maxBlockSize).
+     */
+    [[maybe_unused]] inline void render (PluginProcessor& plugin, juce::AudioBuffer<float>& audio, int maxBlockSize, const std::function<int()>& nextBlockSize)
+    {
+        plugin.setRateAndBufferSizeDetails (sampleRate, maxBlockSize);
+        plugin.prepareToPlay (sampleRate, maxBlockSize);
+
+        juce::MidiBuffer midi;
+        for (int start = 0; start < audio.getNumSamples();)
+        {
+            const auto blockSize = juce::jlimit (1, juce::jmin (maxBlockSize, audio.getNumSamples() - start), nextBlockSize());
+            juce::AudioBuffer<float> block (audio.getArrayOfWritePointers(), numChannels, start, blockSize);
+            plugin.processBlock (block, midi);
+            start += blockSize;
+        }
+
+        plugin.releaseResources();
+    }
+
+    /**
+     * @brief Same, in blocks of maxBlockSize.
+     */
+    [[maybe_unused]] inline void render (PluginProcessor& plugin, juce::AudioBuffer<float>& audio, int maxBlockSize)
+    {
+        render (plugin, audio, maxBlockSize, [maxBlockSize]() { return maxBlockSize; });
+    }
+
+    /**
+     * @brief Peak of the difference between a and b, in dBFS.
+     *        -inf (well, -300) when they're the same.
+     */
+    [[maybe_unused]] inline float getPeakDifferenceDecibels (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        jassert (a.getNumChannels() == b.getNumChannels() && a.getNumSamples() == b.getNumSamples());
+
+        auto peak = 0.0f;
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+            for (int sample = 0; sample < a.getNumSamples(); ++sample)
+                peak = juce::jmax (peak, std::abs (a.getSample (channel, sample) - b.getSample (channel, sample)));
+
+        return juce::Decibels::gainToDecibels (peak, -300.0f);
+    }
+
+    /**
+     * @brief true if every sample of a and b has the same bits.
+     */
+    [[maybe_unused]] inline bool isBitExact (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return false;
+
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+            if (std::memcmp (a.getReadPointer (channel), b.getReadPointer (channel), sizeof (float) * static_cast<size_t> (a.getNumSamples())) != 0)
+                return false;
+
+        return true;
+    }
+}